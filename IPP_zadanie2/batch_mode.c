@@ -0,0 +1,844 @@
+/** @file
+ * Implementation of the interface batch_mode.h
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+// The functions mmap, madvise and sysconf are a part of POSIX.
+#define _DEFAULT_SOURCE
+
+#include "batch_mode.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Describes the length of the input and the output buffer. The lines
+// longer than the input buffer are wrong, unless the input is mapped
+// to the memory.
+#define BATCH_BUFFER_LENGTH (1 << 20)
+
+// Describes the maximal length of an answer other than the board:
+// the decimal number of 64 bits and the new line.
+#define MAX_ANSWER_LENGTH 21
+
+// Describes the number of the commands in the ring between the thread
+// which parses them and the thread which executes them. It must be
+// a power of two.
+#define RING_LENGTH (1 << 12)
+
+// Describes how many commands are handed over the ring at once, so that
+// the threads do not exchange the counters of the ring after every command.
+#define RING_BATCH 64
+
+// Describes how many times a thread checks the ring before it gives
+// the processor to other threads.
+#define SPIN_LIMIT 256
+
+// Describes the length of the cache line, which keeps the data written
+// by different threads apart.
+#define CACHE_LINE 64
+
+// Describes the number of the bytes in which the new lines are found at once.
+#define BLOCK_LENGTH 64
+
+// Describes the number of the bytes of a line which are classified at once.
+#define LINE_WINDOW 32
+
+// Describes the number of the digits which are parsed at once in one word.
+#define SWAR_LENGTH 8
+
+/** @brief The parsed command of one line:
+ * line       - the number of the line,
+ * arguments  - the numbers given in the line,
+ * name       - the letter of the command or zero if the line is wrong.
+ */
+typedef struct Command {
+    uint64_t line;
+    uint32_t arguments[3];
+    char name;
+} command_t;
+
+/** @brief The bounded ring of the commands between the thread which parses
+ * them (the producer) and the thread which executes them (the consumer).
+ * The commands from tail to head - 1 (modulo RING_LENGTH) are parsed and
+ * not executed yet. The counters written by different threads lie in
+ * different cache lines:
+ * head      - the number of the commands put to the ring, written only
+ *             by the producer,
+ * tail      - the number of the commands taken from the ring, written only
+ *             by the consumer,
+ * finished  - true if the producer will not put more commands,
+ * stop      - true if the consumer will not take more commands,
+ * commands  - the commands.
+ */
+typedef struct Ring {
+    _Alignas(CACHE_LINE) atomic_uint_fast64_t head;
+    _Alignas(CACHE_LINE) atomic_uint_fast64_t tail;
+    _Alignas(CACHE_LINE) atomic_bool finished;
+    atomic_bool stop;
+    _Alignas(CACHE_LINE) command_t commands[RING_LENGTH];
+} ring_t;
+
+/** @brief The state of the execution of the commands:
+ * g           - the game,
+ * output      - the file descriptor of the answers,
+ * out         - the output buffer with out_length bytes of the answers
+ *               which are not written yet.
+ */
+typedef struct Batch {
+    _Alignas(CACHE_LINE) game_t* g;
+    int output;
+    char* out;
+    uint64_t out_length;
+} batch_t;
+
+/** @brief The state of the parser of the commands:
+ * input       - the file descriptor of the commands,
+ * in          - the input buffer used if the input is not mapped
+ *               to the memory: its in_end bytes are read and not parsed yet,
+ * limit       - the end of the bytes which may be loaded by the vector
+ *               instructions,
+ * line        - the number of the last parsed line,
+ * skipping    - true if the rest of the too long line is skipped,
+ * avx2        - true if the processor supports the AVX2 instructions,
+ * ring        - the ring to which the commands are put or NULL if they are
+ *               executed at once,
+ * head        - the number of the commands put to the ring,
+ * tail        - the last seen number of the commands taken from the ring,
+ * b           - the state which executes the commands if there is no ring,
+ * failed      - true if reading the input failed,
+ * error       - the value of errno after the failure.
+ */
+typedef struct Parser {
+    _Alignas(CACHE_LINE) int input;
+    char* in;
+    uint64_t in_end;
+    char const* limit;
+    uint64_t line;
+    bool skipping;
+    bool avx2;
+    ring_t* ring;
+    uint64_t head;
+    uint64_t tail;
+    batch_t* b;
+    bool failed;
+    int error;
+} parser_t;
+
+// Writes the length bytes of the buffer to the file descriptor.
+// Returns false if writing failed.
+static bool write_buffer(int fd, char const* buffer, uint64_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, buffer, length);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        buffer += written;
+        length -= (uint64_t)written;
+    }
+
+    return true;
+}
+
+// Writes the answers kept in the output buffer. Returns false if writing failed.
+static bool flush_output(batch_t* b) {
+    bool written = write_buffer(b->output, b->out, b->out_length);
+
+    b->out_length = 0;
+
+    return written;
+}
+
+// Makes sure the output buffer has place for length bytes.
+// Returns false if writing failed.
+static bool reserve_output(batch_t* b, uint64_t length) {
+    return b->out_length + length <= BATCH_BUFFER_LENGTH || flush_output(b);
+}
+
+// Puts the decimal number and the new line to the output buffer,
+// which has place for them.
+static void put_number(batch_t* b, uint64_t number) {
+    char digits[MAX_ANSWER_LENGTH];
+    int length = 0;
+
+    do {
+        digits[length++] = (char)('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
+
+    while (length > 0) {
+        b->out[b->out_length++] = digits[--length];
+    }
+
+    b->out[b->out_length++] = '\n';
+}
+
+// Puts the board to the output buffer. The board which does not fit
+// in the buffer is written in parts straight to the output.
+// Returns false if writing failed.
+static bool put_board(batch_t* b) {
+    uint64_t length = game_board_into(b->g, NULL, 0);
+
+    if (length > BATCH_BUFFER_LENGTH) {
+        return flush_output(b) && game_board_write(b->g, b->output);
+    }
+
+    // The board is written together with its terminating zero,
+    // which is overwritten by the next answer.
+    if (!reserve_output(b, length)) {
+        return false;
+    }
+
+    b->out_length += game_board_into(b->g, &b->out[b->out_length], length) - 1;
+
+    return true;
+}
+
+// Executes the command and puts its answer to the output buffer. Wrong
+// lines are reported on the standard error output. Returns false if
+// writing failed.
+static bool execute_command(batch_t* b, command_t const* c) {
+    if (c->name == 0) {
+        fprintf(stderr, "ERROR %lu\n", c->line);
+
+        return true;
+    }
+
+    if (c->name == 'p') {
+        return put_board(b);
+    }
+
+    if (!reserve_output(b, MAX_ANSWER_LENGTH)) {
+        return false;
+    }
+
+    switch (c->name) {
+        case 'm':
+            put_number(b, game_move(b->g, c->arguments[0], c->arguments[1], c->arguments[2]));
+            break;
+        case 'b':
+            put_number(b, game_busy_fields(b->g, c->arguments[0]));
+            break;
+        case 'f':
+            put_number(b, game_free_fields(b->g, c->arguments[0]));
+            break;
+        default:
+            b->out[b->out_length++] = game_player(b->g, c->arguments[0]);
+            b->out[b->out_length++] = '\n';
+            break;
+    }
+
+    return true;
+}
+
+// Waits a moment for the other thread: at first busily, later giving
+// the processor to other threads.
+static void wait_a_moment(uint32_t* spins) {
+    if (++*spins < SPIN_LIMIT) {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    }
+    else {
+        sched_yield();
+    }
+}
+
+// Hands the commands put to the ring to the consumer.
+static void publish_commands(parser_t* p) {
+    atomic_store_explicit(&p->ring->head, p->head, memory_order_release);
+}
+
+// Puts the command to the ring and hands every RING_BATCH commands to
+// the consumer. Returns false if the consumer stopped taking the commands.
+static bool push_command(parser_t* p, command_t const* c) {
+    ring_t* r = p->ring;
+    uint32_t spins = 0;
+
+    while (p->head - p->tail == RING_LENGTH) {
+        publish_commands(p);
+
+        if (atomic_load_explicit(&r->stop, memory_order_relaxed)) {
+            return false;
+        }
+
+        wait_a_moment(&spins);
+        p->tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    }
+
+    r->commands[p->head++ % RING_LENGTH] = *c;
+
+    if (p->head % RING_BATCH == 0) {
+        publish_commands(p);
+
+        return !atomic_load_explicit(&r->stop, memory_order_relaxed);
+    }
+
+    return true;
+}
+
+// Executes the commands of the ring until the producer finishes.
+// Returns false if writing failed.
+static bool execute_ring(batch_t* b, ring_t* r) {
+    uint64_t tail = 0;
+    uint32_t spins = 0;
+
+    while (true) {
+        uint64_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+        if (head == tail) {
+            // The last commands are published before the producer finishes.
+            if (atomic_load_explicit(&r->finished, memory_order_acquire) &&
+                atomic_load_explicit(&r->head, memory_order_acquire) == tail) {
+                return true;
+            }
+
+            wait_a_moment(&spins);
+
+            continue;
+        }
+
+        spins = 0;
+
+        while (tail != head) {
+            if (!execute_command(b, &r->commands[tail++ % RING_LENGTH])) {
+                atomic_store_explicit(&r->stop, true, memory_order_relaxed);
+
+                return false;
+            }
+
+            if (tail % RING_BATCH == 0) {
+                atomic_store_explicit(&r->tail, tail, memory_order_release);
+            }
+        }
+
+        atomic_store_explicit(&r->tail, tail, memory_order_release);
+    }
+}
+
+// Hands the parsed command to the engine: puts it to the ring or executes
+// it at once. Returns false if the command could not be handed over.
+static bool put_command(parser_t* p, command_t const* c) {
+    if (p->ring) {
+        return push_command(p, c);
+    }
+
+    return execute_command(p->b, c);
+}
+
+// Returns true if the character separates the parts of a line.
+static bool is_blank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+// Returns true if the character is a decimal digit.
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Parses the decimal digits from the position to the end of the line.
+// Returns the number of the digits and sets the value to the number they
+// describe if it fits in uint32_t or to a bigger number otherwise.
+static uint64_t parse_digits_scalar(char const* position, char const* end,
+                                    uint64_t* value) {
+    uint64_t count = 0;
+
+    *value = 0;
+
+    for (; &position[count] != end && is_digit(position[count]); count++) {
+        if (*value <= UINT32_MAX) {
+            *value = *value * 10 + (uint64_t)(position[count] - '0');
+        }
+    }
+
+    return count;
+}
+
+// Reads the number after at least one blank character from the position
+// to the end of the line. Returns false if there is no number or it does
+// not fit in uint32_t.
+static bool read_number(char const** position, char const* end, uint32_t* number) {
+    char const* p = *position;
+    uint64_t value;
+    uint64_t count;
+
+    if (p == end || !is_blank(*p)) {
+        return false;
+    }
+
+    while (p != end && is_blank(*p)) {
+        p++;
+    }
+
+    count = parse_digits_scalar(p, end, &value);
+
+    if (count == 0 || value > UINT32_MAX) {
+        return false;
+    }
+
+    *position = p + count;
+    *number = (uint32_t)value;
+
+    return true;
+}
+
+// Returns true if there are only blank characters from the position
+// to the end of the line.
+static bool line_ends(char const* position, char const* end) {
+    while (position != end && is_blank(*position)) {
+        position++;
+    }
+
+    return position == end;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Sets the masks of the digits and of the blank characters among
+// the LINE_WINDOW bytes from the position: the bit i is set if the byte i
+// is a digit or a blank character. Used only if the processor supports
+// the AVX2 instructions.
+__attribute__((target("avx2")))
+static void classify_avx2(char const* position, uint32_t* digits, uint32_t* blanks) {
+    __m256i text = _mm256_loadu_si256((__m256i const*)position);
+    __m256i values = _mm256_sub_epi8(text, _mm256_set1_epi8('0'));
+    __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(values, _mm256_set1_epi8(9)),
+                                         values);
+    __m256i is_blank = _mm256_or_si256(_mm256_cmpeq_epi8(text, _mm256_set1_epi8(' ')),
+                                       _mm256_cmpeq_epi8(text, _mm256_set1_epi8('\t')));
+
+    *digits = (uint32_t)_mm256_movemask_epi8(is_digit);
+    *blanks = (uint32_t)_mm256_movemask_epi8(is_blank);
+}
+
+// Returns the number described by the length (from 1 to SWAR_LENGTH)
+// digits from the position, which are parsed together as the bytes of one
+// little endian word. The SWAR_LENGTH bytes from the position have to be
+// readable.
+static uint64_t parse_digits_swar(char const* position, uint64_t length) {
+    uint64_t word;
+
+    memcpy(&word, position, SWAR_LENGTH);
+
+    // The first digit is the lowest byte. The bytes after the number are
+    // shifted out and zeros come in place of the missing leading digits.
+    word = (word - 0x3030303030303030ULL) << (8 * (SWAR_LENGTH - length));
+
+    // The neighbouring digits are joined in pairs, then in numbers of four
+    // and eight digits.
+    word = (word * 10 + (word >> 8)) & 0x00FF00FF00FF00FFULL;
+    word = (word * 100 + (word >> 16)) & 0x0000FFFF0000FFFFULL;
+
+    return (word * 10000 + (word >> 32)) & 0xFFFFFFFFULL;
+}
+
+// The same as the loop of read_number for the line from begin of the given
+// length, which is shorter than LINE_WINDOW, but finds the numbers with
+// the masks of its digits and blank characters instead of reading it
+// character by character. The SWAR_LENGTH bytes after the line have to be
+// readable.
+static bool read_numbers_by_masks(char const* begin, uint64_t length, uint32_t digits,
+                                  uint32_t blanks, int count, uint32_t* numbers) {
+    // The characters after the command.
+    uint32_t rest = (((uint32_t)1 << length) - 1) & ~(uint32_t)1;
+    uint32_t starts;
+
+    digits &= rest;
+    starts = digits & ~(digits << 1);
+
+    // The numbers are separated by the blank characters from the command
+    // and from each other.
+    if (((digits | blanks) & rest) != rest || (digits & 2) != 0) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (starts == 0) {
+            return false;
+        }
+
+        uint32_t start = (uint32_t)__builtin_ctz(starts);
+        uint64_t digits_count = (uint64_t)__builtin_ctz(~(digits >> start));
+        uint64_t value;
+
+        starts &= starts - 1;
+
+        if (digits_count <= SWAR_LENGTH) {
+            value = parse_digits_swar(&begin[start], digits_count);
+        }
+        else if (digits_count <= 2 * SWAR_LENGTH) {
+            value = parse_digits_swar(&begin[start], digits_count - SWAR_LENGTH) * 100000000 +
+                    parse_digits_swar(&begin[start + digits_count - SWAR_LENGTH], SWAR_LENGTH);
+        }
+        else {
+            parse_digits_scalar(&begin[start], &begin[length], &value);
+        }
+
+        if (value > UINT32_MAX) {
+            return false;
+        }
+
+        numbers[i] = (uint32_t)value;
+    }
+
+    return starts == 0;
+}
+#endif
+
+// Reads count numbers of the line from begin to end, which follow
+// the command. Returns false if the line does not consist of the command
+// and the numbers separated by the blank characters.
+static bool read_numbers(parser_t const* p, char const* begin, char const* end, int count,
+                         uint32_t* numbers) {
+    char const* position = begin + 1;
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Short lines are checked at once, if the vector load does not leave
+    // the readable bytes.
+    if (p->avx2 && end - begin < LINE_WINDOW && p->limit - begin >= LINE_WINDOW + SWAR_LENGTH) {
+        uint32_t digits;
+        uint32_t blanks;
+
+        classify_avx2(begin, &digits, &blanks);
+
+        return read_numbers_by_masks(begin, (uint64_t)(end - begin), digits, blanks,
+                                     count, numbers);
+    }
+#else
+    (void)p;
+#endif
+
+    for (int i = 0; i < count; i++) {
+        if (!read_number(&position, end, &numbers[i])) {
+            return false;
+        }
+    }
+
+    return line_ends(position, end);
+}
+
+// Parses the line from begin to end (without the new line) and hands its
+// command to the engine. Returns false if the command could not be handed
+// over.
+static bool parse_line(parser_t* p, char const* begin, char const* end) {
+    command_t c = {.line = ++p->line};
+    int count = 0;
+
+    if (begin == end || *begin == '#') {
+        return true;
+    }
+
+    switch (*begin) {
+        case 'm':
+            count = 3;
+            break;
+        case 'b':
+        case 'f':
+        case 'q':
+            count = 1;
+            break;
+        case 'p':
+            count = 0;
+            break;
+        default:
+            count = -1;
+            break;
+    }
+
+    if (count >= 0 && read_numbers(p, begin, end, count, c.arguments)) {
+        c.name = *begin;
+    }
+
+    return put_command(p, &c);
+}
+
+// Returns the mask of the new lines among the length bytes of the block:
+// its bit i is set if the byte i is the new line.
+static uint64_t newline_mask_scalar(char const* block, uint64_t length) {
+    uint64_t mask = 0;
+    char const* newline = memchr(block, '\n', length);
+
+    while (newline) {
+        uint64_t i = (uint64_t)(newline - block);
+
+        mask |= (uint64_t)1 << i;
+        newline = memchr(newline + 1, '\n', length - i - 1);
+    }
+
+    return mask;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// The same as newline_mask_scalar for the BLOCK_LENGTH bytes, but compares
+// 32 bytes at once with AVX2 instructions. Used only if the processor
+// supports them.
+__attribute__((target("avx2")))
+static uint64_t newline_mask_avx2(char const* block) {
+    __m256i newline = _mm256_set1_epi8('\n');
+    __m256i low = _mm256_loadu_si256((__m256i const*)block);
+    __m256i high = _mm256_loadu_si256((__m256i const*)&block[32]);
+    uint32_t low_mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline));
+    uint32_t high_mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline));
+
+    return (uint64_t)high_mask << 32 | low_mask;
+}
+#endif
+
+// Returns the mask of the new lines among the length bytes of the block
+// found with the fastest function supported by the processor.
+static uint64_t newline_mask(parser_t const* p, char const* block, uint64_t length) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (p->avx2 && length == BLOCK_LENGTH) {
+        return newline_mask_avx2(block);
+    }
+#endif
+
+    return newline_mask_scalar(block, length);
+}
+
+// Parses all whole lines from begin to end. Returns the beginning of the
+// rest of the last line or NULL if a command could not be handed over.
+static char const* parse_lines(parser_t* p, char const* begin, char const* end) {
+    char const* line = begin;
+
+    for (char const* block = begin; block < end; block += BLOCK_LENGTH) {
+        uint64_t length = (uint64_t)(end - block);
+        uint64_t mask = newline_mask(p, block, length < BLOCK_LENGTH ? length : BLOCK_LENGTH);
+
+        while (mask != 0) {
+            char const* newline = &block[__builtin_ctzll(mask)];
+
+            mask &= mask - 1;
+
+            // The end of the too long line is not executed, but it is counted.
+            if (p->skipping) {
+                p->skipping = false;
+                p->line++;
+            }
+            else if (!parse_line(p, line, newline)) {
+                return NULL;
+            }
+
+            line = newline + 1;
+        }
+    }
+
+    return line;
+}
+
+// Reads and parses all commands of the input with the input buffer.
+// Returns false if reading failed or a command could not be handed over.
+static bool parse_stream(parser_t* p) {
+    p->in = malloc(BATCH_BUFFER_LENGTH);
+
+    if (!p->in) {
+        errno = ENOMEM;
+        p->failed = true;
+
+        return false;
+    }
+
+    while (true) {
+        ssize_t length = read(p->input, &p->in[p->in_end], BATCH_BUFFER_LENGTH - p->in_end);
+
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            p->failed = true;
+
+            return false;
+        }
+
+        if (length == 0) {
+            break;
+        }
+
+        p->in_end += (uint64_t)length;
+        p->limit = &p->in[p->in_end];
+
+        char const* rest = parse_lines(p, p->in, p->limit);
+
+        if (!rest) {
+            return false;
+        }
+
+        p->in_end = (uint64_t)(p->limit - rest);
+        memmove(p->in, rest, p->in_end);
+
+        // The line does not fit in the buffer.
+        if (p->in_end == BATCH_BUFFER_LENGTH) {
+            command_t wrong = {.line = p->line + 1};
+
+            if (!p->skipping && !put_command(p, &wrong)) {
+                return false;
+            }
+
+            p->skipping = true;
+            p->in_end = 0;
+        }
+    }
+
+    // The last line may have no new line at its end.
+    if (p->in_end > 0 && !p->skipping) {
+        p->limit = &p->in[p->in_end];
+
+        return parse_line(p, p->in, p->limit);
+    }
+
+    return true;
+}
+
+// Parses all commands from begin to end of the input mapped to the memory.
+// Returns false if a command could not be handed over.
+static bool parse_mapped(parser_t* p, char const* begin, char const* end) {
+    p->limit = end;
+
+    char const* rest = parse_lines(p, begin, end);
+
+    // The last line may have no new line at its end.
+    return rest && (rest == end || parse_line(p, rest, end));
+}
+
+// Parses all commands of the input. The rest of a regular file is mapped
+// to the memory and other inputs are read to the input buffer. Returns
+// false if reading failed or a command could not be handed over.
+static bool parse_input(parser_t* p) {
+    struct stat status;
+    off_t offset = lseek(p->input, 0, SEEK_CUR);
+
+    if (offset >= 0 && fstat(p->input, &status) == 0 && S_ISREG(status.st_mode)) {
+        if (offset >= status.st_size) {
+            return true;
+        }
+
+        // The mapping starts at the beginning of a page.
+        off_t start = offset - offset % sysconf(_SC_PAGESIZE);
+        uint64_t length = (uint64_t)(status.st_size - start);
+        char* data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, p->input, start);
+
+        if (data != MAP_FAILED) {
+            madvise(data, length, MADV_SEQUENTIAL);
+
+            bool parsed = parse_mapped(p, &data[offset - start], &data[length]);
+
+            munmap(data, length);
+            lseek(p->input, status.st_size, SEEK_SET);
+
+            return parsed;
+        }
+    }
+
+    return parse_stream(p);
+}
+
+// The thread which parses the commands and puts them to the ring.
+static void* parser_thread(void* data) {
+    parser_t* p = data;
+
+    if (!parse_input(p)) {
+        p->error = errno;
+    }
+
+    publish_commands(p);
+    atomic_store_explicit(&p->ring->finished, true, memory_order_release);
+
+    return NULL;
+}
+
+// Creates the ring and the thread which parses the commands, if there is
+// another processor for it. Returns false if the commands are parsed
+// by the thread executing them.
+static bool start_parser_thread(parser_t* p, pthread_t* thread) {
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2) {
+        return false;
+    }
+
+    p->ring = aligned_alloc(CACHE_LINE, sizeof(ring_t));
+
+    if (!p->ring) {
+        return false;
+    }
+
+    atomic_init(&p->ring->head, 0);
+    atomic_init(&p->ring->tail, 0);
+    atomic_init(&p->ring->finished, false);
+    atomic_init(&p->ring->stop, false);
+
+    if (pthread_create(thread, NULL, parser_thread, p) != 0) {
+        free(p->ring);
+        p->ring = NULL;
+
+        return false;
+    }
+
+    return true;
+}
+
+bool batch_mode_run(game_t* g, int input, int output) {
+    batch_t b = {.g = g, .output = output};
+    parser_t p = {.input = input, .b = &b};
+    pthread_t thread;
+    bool success;
+
+#if defined(__x86_64__) || defined(__i386__)
+    p.avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    b.out = malloc(BATCH_BUFFER_LENGTH);
+
+    if (!b.out) {
+        errno = ENOMEM;
+
+        return false;
+    }
+
+    // The commands are parsed and executed in separate threads, if it is
+    // possible. Otherwise every command is executed right after parsing.
+    if (start_parser_thread(&p, &thread)) {
+        success = execute_ring(&b, p.ring);
+
+        int error = errno;
+
+        pthread_join(thread, NULL);
+        free(p.ring);
+
+        if (!success) {
+            errno = error;
+        }
+        else if (p.failed) {
+            success = false;
+            errno = p.error;
+        }
+    }
+    else {
+        success = parse_input(&p);
+    }
+
+    // The answers are written also when the input could not be read.
+    success = flush_output(&b) && success;
+    free(p.in);
+    free(b.out);
+
+    return success;
+}
@@ -0,0 +1,47 @@
+/** @file
+ * Interfejs trybu wsadowego gry, w którym polecenia są czytane z pliku
+ * lub potoku, a odpowiedzi zapisywane bez trybu tekstowego ncurses.
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+#ifndef BATCH_MODE_H
+#define BATCH_MODE_H
+
+#include "game.h"
+
+/** @brief Przeprowadza grę w trybie wsadowym.
+ * Czyta z deskryptora @p input polecenia, po jednym w wierszu, i wykonuje
+ * je na grze @p g. Odpowiedź na każde polecenie jest zapisywana
+ * do deskryptora @p output w osobnym wierszu:
+ * - <tt>m player x y</tt> – wynik funkcji @ref game_move: 1 albo 0,
+ * - <tt>b player</tt> – wynik funkcji @ref game_busy_fields,
+ * - <tt>f player</tt> – wynik funkcji @ref game_free_fields,
+ * - <tt>q player</tt> – wynik funkcji @ref game_player,
+ * - <tt>p</tt> – napis opisujący stan planszy (zob. @ref game_board), który
+ *   sam kończy się znakiem nowej linii.
+ *
+ * Liczby są dziesiętne i oddzielone od polecenia i od siebie spacjami lub
+ * tabulacjami. Puste wiersze i wiersze zaczynające się znakiem '#' są
+ * pomijane. Dla każdego innego błędnego wiersza na standardowe wyjście
+ * diagnostyczne wypisywany jest komunikat <tt>ERROR n</tt>, gdzie @p n jest
+ * numerem wiersza, i nic nie jest zapisywane do @p output. Wejście i wyjście
+ * są przetwarzane w dużych buforach, więc odpowiedzi są zapisywane dopiero
+ * po zapełnieniu bufora i po przeczytaniu całego wejścia. Jeśli @p input jest
+ * zwykłym plikiem, jego pozostała część jest odwzorowywana w pamięci zamiast
+ * czytania. Gdy dostępny jest więcej niż jeden procesor, polecenia są
+ * parsowane w osobnym wątku i przekazywane przez ograniczoną kolejkę
+ * do wątku wywołującego, który wykonuje je na grze w kolejności wierszy.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] input   – deskryptor, z którego czytane są polecenia,
+ * @param[in] output  – deskryptor, do którego zapisywane są odpowiedzi.
+ * @return Wartość @p true, jeśli całe wejście zostało przetworzone, a @p false,
+ * gdy nie udało się alokować pamięci na bufory albo czytanie lub zapisywanie
+ * się nie powiodło (wtedy pozostaje ustawiona wartość @p errno).
+ */
+bool batch_mode_run(game_t *g, int input, int output);
+
+#endif /* BATCH_MODE_H */
@@ -0,0 +1,501 @@
+/** @file
+ * Implementation of the interface computer_player.h
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+// The functions clock_gettime and sysconf are a part of POSIX.
+#define _DEFAULT_SOURCE
+
+#include "computer_player.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
+// Describes the maximal number of nodes of the search tree of one thread.
+// The tree stops growing when it is full and the search goes on with
+// the rollouts from its leaves.
+#define MAX_NODES (1 << 20)
+
+// Describes how many times the array of the nodes grows when it is full.
+#define NODES_GROWTH 2
+
+// Describes the exploration constant of the UCB1 formula.
+#define EXPLORATION 1.4
+
+// Describes how many random fields a rollout tries before it lists
+// the legal moves of the player.
+#define RANDOM_TRIES 4
+
+/** @brief A node of the search tree, i.e. the state of the game after
+ * the move:
+ * field           - the field of the move,
+ * player          - the player who made the move,
+ * visits          - the number of the rollouts through the node,
+ * reward          - the sum of the rewards of the player in these rollouts,
+ * first_child     - the index of the first child in the nodes array or zero
+ *                   if the node is not expanded yet (the root is never
+ *                   a child),
+ * children_count  - the number of the children, i.e. the legal moves
+ *                   of the next player.
+ */
+typedef struct Node {
+    game_field_t field;
+    uint32_t player;
+    uint32_t visits;
+    double reward;
+    uint32_t first_child;
+    uint32_t children_count;
+} node_t;
+
+/** @brief The state of one searching thread:
+ * c               - the search the thread belongs to,
+ * g               - the copy of the game changed by the thread; every
+ *                   rollout undoes its moves, so the game comes back
+ *                   to the searched state,
+ * nodes           - the search tree, nodes[0] is the root,
+ * nodes_length    - the number of the nodes of the tree,
+ * nodes_capacity  - the length of nodes array, which starts with place
+ *                   for the children of the root and grows with the tree
+ *                   up to MAX_NODES,
+ * path            - the nodes visited by the current rollout,
+ * moves           - the place for the legal moves of a player,
+ * moves_capacity  - the length of moves array,
+ * rewards         - rewards[p] is the reward of the player p in the current
+ *                   rollout,
+ * random          - the state of the random number generator,
+ * rollouts        - the number of the finished rollouts,
+ * thread          - the thread.
+ */
+typedef struct Worker {
+    computer_player_t* c;
+    game_t* g;
+    node_t* nodes;
+    uint32_t nodes_length;
+    uint32_t nodes_capacity;
+    uint32_t* path;
+    game_field_t* moves;
+    uint64_t moves_capacity;
+    double* rewards;
+    uint64_t random;
+    atomic_uint_fast64_t rollouts;
+    pthread_t thread;
+} worker_t;
+
+/** @brief The search of the move of the computer player. Every thread builds
+ * its own tree (root parallelisation) and the visits of the moves of the root
+ * are summed at the end:
+ * workers         - the states of the threads,
+ * workers_count   - the number of the threads,
+ * player          - the player who makes the move,
+ * start           - the time of the start of the search in seconds,
+ * deadline        - the time of the end of the search in seconds,
+ * stop            - true if the search was stopped,
+ * finished        - the number of the finished threads.
+ */
+struct computer_player {
+    worker_t* workers;
+    uint32_t workers_count;
+    uint32_t player;
+    double start;
+    double deadline;
+    atomic_bool stop;
+    atomic_uint finished;
+};
+
+// Returns the current time in seconds.
+static double now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+// Returns the next random number of the thread (xorshift64*).
+static uint64_t next_random(worker_t* w) {
+    w->random ^= w->random >> 12;
+    w->random ^= w->random << 25;
+    w->random ^= w->random >> 27;
+
+    return w->random * 2685821657736338717ULL;
+}
+
+// Makes sure the array of the nodes has place for count more nodes.
+// Returns false if the tree would have more than MAX_NODES nodes or there
+// is no memory.
+static bool reserve_nodes(worker_t* w, uint64_t count) {
+    uint64_t needed = w->nodes_length + count;
+
+    if (needed <= w->nodes_capacity) {
+        return true;
+    }
+    if (needed > MAX_NODES) {
+        return false;
+    }
+
+    uint64_t capacity = (uint64_t)w->nodes_capacity * NODES_GROWTH;
+
+    if (capacity < needed) {
+        capacity = needed;
+    }
+    if (capacity > MAX_NODES) {
+        capacity = MAX_NODES;
+    }
+
+    node_t* nodes = realloc(w->nodes, capacity * sizeof(node_t));
+
+    if (!nodes) {
+        return false;
+    }
+
+    w->nodes = nodes;
+    w->nodes_capacity = (uint32_t)capacity;
+
+    return true;
+}
+
+// Adds the legal moves of the player as the children of the node.
+// Returns false if they do not fit in the tree.
+static bool expand(worker_t* w, uint32_t node, uint32_t player) {
+    uint64_t count = game_free_fields(w->g, player);
+
+    if (!reserve_nodes(w, count)) {
+        return false;
+    }
+
+    game_legal_moves_iterator_t it;
+    node_t* child = &w->nodes[w->nodes_length];
+    game_field_t field;
+
+    w->nodes[node].first_child = w->nodes_length;
+    game_legal_moves_begin(w->g, player, &it);
+
+    while (game_legal_moves_next(&it, &field)) {
+        *child = (node_t){.field = field, .player = player};
+        child++;
+    }
+
+    w->nodes[node].children_count = (uint32_t)(child - &w->nodes[w->nodes_length]);
+    w->nodes_length += w->nodes[node].children_count;
+
+    return true;
+}
+
+// Returns the index of the child of the node with the best UCB1 value.
+// The children which were never visited go first.
+static uint32_t select_child(worker_t const* w, node_t const* node) {
+    double log_visits = log((double)node->visits);
+    uint32_t best = node->first_child;
+    double best_value = -1.0;
+
+    for (uint32_t i = node->first_child; i < node->first_child + node->children_count; i++) {
+        node_t const* child = &w->nodes[i];
+
+        if (child->visits == 0) {
+            return i;
+        }
+
+        double value = child->reward / child->visits +
+                       EXPLORATION * sqrt(log_visits / child->visits);
+
+        if (value > best_value) {
+            best = i;
+            best_value = value;
+        }
+    }
+
+    return best;
+}
+
+// Plays random moves starting from the player until no player can move
+// and adds the number of the made moves to made. Most fields are legal at
+// the beginning of the game, so random fields are tried before the legal
+// moves are listed. Returns false if a listed legal move was rejected, so
+// the game is not in the state the moves describe.
+static bool rollout(worker_t* w, uint32_t player, uint64_t* made) {
+    game_t* g = w->g;
+    uint32_t width = game_board_width(g);
+    uint32_t height = game_board_height(g);
+    uint64_t fields = (uint64_t)width * height;
+
+    do {
+        uint64_t free_fields = game_free_fields(g, player);
+        bool moved = false;
+
+        for (int i = 0; i < RANDOM_TRIES && 4 * free_fields >= fields && !moved; i++) {
+            uint64_t random = next_random(w);
+
+            moved = game_move(g, player, (uint32_t)(random % width),
+                              (uint32_t)((random >> 32) % height));
+        }
+
+        if (!moved) {
+            uint64_t length = game_legal_moves(g, player, w->moves, w->moves_capacity);
+            game_field_t field = w->moves[next_random(w) % length];
+
+            if (!game_move(g, player, field.x, field.y)) {
+                return false;
+            }
+        }
+
+        (*made)++;
+    } while (find_next_player(g, &player));
+
+    return true;
+}
+
+// Sets the rewards of the finished game: the players with the most fields
+// share the win.
+static void score(worker_t* w) {
+    uint32_t players = game_players(w->g);
+    uint64_t best = 0;
+    uint32_t winners = 0;
+
+    for (uint32_t p = 1; p <= players; p++) {
+        uint64_t fields = game_busy_fields(w->g, p);
+
+        if (fields > best) {
+            best = fields;
+            winners = 0;
+        }
+
+        winners += fields == best;
+    }
+
+    for (uint32_t p = 1; p <= players; p++) {
+        w->rewards[p] = game_busy_fields(w->g, p) == best ? 1.0 / winners : 0.0;
+    }
+}
+
+// Makes one rollout: goes down the tree, expands the node visited for
+// the second time, plays the game to the end, updates the visited nodes
+// and undoes all moves. If a move of the tree or a legal move of the rollout
+// is rejected, the game is out of sync with the tree, so the rollout ends
+// without updating the nodes.
+static void search(worker_t* w) {
+    game_t* g = w->g;
+    uint32_t player = w->c->player;
+    uint32_t node = 0;
+    uint32_t path_length = 1;
+    uint64_t made = 0;
+    bool ended = false;
+    bool correct = true;
+
+    w->path[0] = 0;
+
+    while (w->nodes[node].first_child != 0 || (w->nodes[node].visits > 0 &&
+                                              expand(w, node, player))) {
+        node = select_child(w, &w->nodes[node]);
+
+        if (!game_move(g, player, w->nodes[node].field.x, w->nodes[node].field.y)) {
+            correct = false;
+            break;
+        }
+
+        made++;
+        w->path[path_length] = node;
+        path_length++;
+
+        if (!find_next_player(g, &player)) {
+            ended = true;
+            break;
+        }
+        if (w->nodes[node].visits == 0) {
+            break;
+        }
+    }
+
+    if (correct && !ended) {
+        correct = rollout(w, player, &made);
+    }
+
+    if (correct) {
+        score(w);
+
+        for (uint32_t i = 0; i < path_length; i++) {
+            node_t* visited = &w->nodes[w->path[i]];
+
+            visited->visits++;
+            visited->reward += w->rewards[visited->player];
+        }
+    }
+
+    for (uint64_t i = 0; i < made; i++) {
+        game_undo(g);
+    }
+
+    if (correct) {
+        atomic_fetch_add_explicit(&w->rollouts, 1, memory_order_relaxed);
+    }
+}
+
+// The function of the searching thread.
+static void* search_thread(void* data) {
+    worker_t* w = data;
+    computer_player_t* c = w->c;
+
+    // The root is expanded at once, so all threads have the same children
+    // of the root in the same order.
+    if (expand(w, 0, c->player)) {
+        while (!atomic_load_explicit(&c->stop, memory_order_relaxed) && now() < c->deadline) {
+            search(w);
+        }
+    }
+
+    atomic_fetch_add(&c->finished, 1);
+
+    return NULL;
+}
+
+// Frees the memory of the first count workers and of the search.
+static void remove_computer_player(computer_player_t* c, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        worker_t* w = &c->workers[i];
+
+        game_delete(w->g);
+        free(w->nodes);
+        free(w->path);
+        free(w->moves);
+        free(w->rewards);
+    }
+
+    free(c->workers);
+    free(c);
+}
+
+// Prepares the worker searching in the copy of the game. Returns false
+// if there is no memory.
+static bool start_worker(computer_player_t* c, worker_t* w, game_t* g, uint32_t index) {
+    uint64_t fields = game_general_free_fields(g) + 1;
+    uint64_t root_children = game_free_fields(g, c->player);
+
+    w->c = c;
+    w->g = game_clone(g);
+    w->nodes_capacity = root_children < MAX_NODES ? (uint32_t)root_children + 1 : MAX_NODES;
+    w->nodes = malloc(w->nodes_capacity * sizeof(node_t));
+    w->nodes_length = 1;
+    w->path = malloc(fields * sizeof(uint32_t));
+    w->moves = malloc(fields * sizeof(game_field_t));
+    w->moves_capacity = fields;
+    w->rewards = calloc(game_players(g) + 1, sizeof(double));
+    w->random = (uint64_t)(now() * 1e9) ^ (index + 1) * 0x9e3779b97f4a7c15ULL;
+    atomic_init(&w->rollouts, 0);
+
+    if (!w->g || !w->nodes || !w->path || !w->moves || !w->rewards ||
+        !game_history_enable(w->g)) {
+        return false;
+    }
+
+    w->nodes[0] = (node_t){.player = 0};
+
+    return true;
+}
+
+computer_player_t* computer_player_start(game_t* g, uint32_t player,
+                                         uint64_t milliseconds) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t count = processors > 0 ? (uint32_t)processors : 1;
+    computer_player_t* c = calloc(1, sizeof(computer_player_t));
+
+    if (!c) {
+        return NULL;
+    }
+
+    c->workers = calloc(count, sizeof(worker_t));
+    c->player = player;
+    c->start = now();
+    c->deadline = c->start + (double)milliseconds * 1e-3;
+    atomic_init(&c->stop, false);
+    atomic_init(&c->finished, 0);
+
+    if (!c->workers) {
+        free(c);
+
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (!start_worker(c, &c->workers[i], g, i)) {
+            remove_computer_player(c, i + 1);
+
+            return NULL;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (pthread_create(&c->workers[i].thread, NULL, search_thread, &c->workers[i]) != 0) {
+            atomic_store(&c->stop, true);
+
+            for (uint32_t j = 0; j < i; j++) {
+                pthread_join(c->workers[j].thread, NULL);
+            }
+
+            remove_computer_player(c, count);
+
+            return NULL;
+        }
+
+        c->workers_count++;
+    }
+
+    return c;
+}
+
+bool computer_player_ready(computer_player_t const* c) {
+    return atomic_load(&c->finished) == c->workers_count;
+}
+
+uint64_t computer_player_rollouts(computer_player_t const* c) {
+    uint64_t rollouts = 0;
+
+    for (uint32_t i = 0; i < c->workers_count; i++) {
+        rollouts += atomic_load_explicit(&c->workers[i].rollouts, memory_order_relaxed);
+    }
+
+    return rollouts;
+}
+
+void computer_player_stop(computer_player_t* c) {
+    atomic_store(&c->stop, true);
+}
+
+bool computer_player_finish(computer_player_t* c, game_field_t* field,
+                            uint64_t* rollouts, double* seconds) {
+    for (uint32_t i = 0; i < c->workers_count; i++) {
+        pthread_join(c->workers[i].thread, NULL);
+    }
+
+    *rollouts = computer_player_rollouts(c);
+    *seconds = now() - c->start;
+
+    // The root of every tree has the same children, so the visits of
+    // the moves are summed over the trees.
+    node_t const* root = &c->workers[0].nodes[0];
+    uint64_t best_visits = 0;
+    bool found = root->first_child != 0;
+
+    for (uint32_t i = 0; found && i < root->children_count; i++) {
+        uint64_t visits = 0;
+
+        for (uint32_t j = 0; j < c->workers_count; j++) {
+            node_t const* nodes = c->workers[j].nodes;
+
+            visits += nodes[0].first_child != 0 ? nodes[nodes[0].first_child + i].visits : 0;
+        }
+
+        if (i == 0 || visits > best_visits) {
+            *field = c->workers[0].nodes[root->first_child + i].field;
+            best_visits = visits;
+        }
+    }
+
+    remove_computer_player(c, c->workers_count);
+
+    return found;
+}
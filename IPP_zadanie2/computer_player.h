@@ -0,0 +1,76 @@
+/** @file
+ * Interfejs gracza komputerowego wybierającego ruch metodą Monte Carlo
+ * Tree Search.
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+#ifndef COMPUTER_PLAYER_H
+#define COMPUTER_PLAYER_H
+
+#include "game.h"
+
+/**
+ * To jest deklaracja struktury przechowującej stan wyszukiwania ruchu
+ * gracza komputerowego.
+ */
+typedef struct computer_player computer_player_t;
+
+/** @brief Zaczyna wyszukiwanie ruchu gracza komputerowego.
+ * Uruchamia po jednym wątku na każdy procesor. Każdy wątek buduje własne
+ * drzewo przeszukiwania na kopii gry (zob. @ref game_clone), rozgrywając
+ * do końca losowe partie i cofając ich ruchy (zob. @ref game_undo). Wątki
+ * kończą pracę po upływie @p milliseconds milisekund albo po wywołaniu
+ * funkcji @ref computer_player_stop. Do tego czasu gry @p g nie wolno
+ * zmieniać.
+ * @param[in,out] g        – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player       – numer gracza, który wykonuje ruch, gracz musi
+ *                           mieć wolne pole,
+ * @param[in] milliseconds – czas na wybór ruchu w milisekundach.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * alokować pamięci lub uruchomić wątków.
+ */
+computer_player_t* computer_player_start(game_t *g, uint32_t player,
+                                         uint64_t milliseconds);
+
+/** @brief Sprawdza, czy ruch został wybrany.
+ * Nie czeka na wątki.
+ * @param[in] c       – wskaźnik na strukturę przechowującą stan wyszukiwania.
+ * @return Wartość @p true, jeśli wszystkie wątki zakończyły pracę,
+ * a @p false w przeciwnym przypadku.
+ */
+bool computer_player_ready(computer_player_t const *c);
+
+/** @brief Podaje liczbę rozegranych dotąd partii.
+ * @param[in] c       – wskaźnik na strukturę przechowującą stan wyszukiwania.
+ * @return Liczba partii rozegranych przez wszystkie wątki.
+ */
+uint64_t computer_player_rollouts(computer_player_t const *c);
+
+/** @brief Przerywa wyszukiwanie ruchu.
+ * Wątki kończą pracę po rozegraniu bieżących partii.
+ * @param[in,out] c   – wskaźnik na strukturę przechowującą stan wyszukiwania.
+ */
+void computer_player_stop(computer_player_t *c);
+
+/** @brief Kończy wyszukiwanie ruchu.
+ * Czeka na zakończenie wątków, podaje najczęściej odwiedzany ruch i usuwa
+ * strukturę wskazywaną przez @p c.
+ * @param[in,out] c     – wskaźnik na strukturę przechowującą stan
+ *                        wyszukiwania,
+ * @param[out] field    – wskaźnik, pod którym umieszczane jest wybrane pole,
+ * @param[out] rollouts – wskaźnik, pod którym umieszczana jest liczba
+ *                        rozegranych partii,
+ * @param[out] seconds  – wskaźnik, pod którym umieszczany jest czas
+ *                        wyszukiwania w sekundach.
+ * @return Wartość @p true, jeśli ruch został wybrany, a @p false, gdy
+ * ruchy gracza nie mieszczą się w drzewie przeszukiwania albo nie udało się
+ * alokować na nie pamięci.
+ */
+bool computer_player_finish(computer_player_t *c, game_field_t *field,
+                            uint64_t *rollouts, double *seconds);
+
+#endif /* COMPUTER_PLAYER_H */
@@ -7,14 +7,47 @@
  * @date 2023
  */
 
+// The functions writev, sysconf and mmap are a part of POSIX and
+// the flags MAP_NORESERVE and MADV_HUGEPAGE are extensions of it.
+#define _DEFAULT_SOURCE
+
 #include "game.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/** @brief Type of the fields of the owners plane of the game board.
+ * Keeps the owner tag of the player of the field (see owner_tag) or zero
+ * if the field is empty. The tag is the player number if it is at most
+ * MAX_OWNER_TAG, so the owners plane of the games with more players does
+ * not grow; their player numbers are kept for the areas (see area_owner
+ * in the game structure).
+ */
+typedef uint8_t owner_t;
+
+/** @brief Type of the fields of the colors plane of the game board.
+ * Keeps the number of the area created by the game_move function
+ * (see area_parent in the game structure). Zero is never used
+ * as the number of an area.
+ */
+typedef uint32_t area_t;
 
 /** @brief An auxiliary structure which keeps the player number and
- * the "color" of the field in the game_board (i.e. the number
- * of calls of the game_move function).
+ * the "color" of some neighbour field (i.e. the number of the whole
+ * area the field belongs to).
  */
 typedef struct Pair {
-    uint64_t color;
+    area_t color;
     uint32_t player_number;
 } pair_t;
 
@@ -33,27 +66,425 @@ typedef struct Pair {
  *                   areas but still can play putting figures on the
  *                   "boundary" of already existing connected fragment marked
  *                   by his number),
- * player_symbol   - symbol describing the player on the game board.
+ * frontier        - the array of all empty fields having a neighbour with
+ *                   the player figure (i.e. the "boundary" of the player).
+ *                   It may also keep fields which were taken later; they are
+ *                   removed when they outnumber the boundary_length fields,
+ * frontier_length - the length of frontier array,
+ * frontier_capacity - the allocated length of frontier array,
+ * frontier_mapped - true if frontier array is a part of the file mapped
+ *                   by game_load (then it is not freed and it is copied
+ *                   when it grows),
+ * blocked         - true if the player occupied all areas and he has no free
+ *                   field next to them, so he cannot move (the same as his bit
+ *                   in the blocked bitmap of his page, see players_page_t).
+ * The players are kept in the pages of the players table (see player_pages
+ * in the game structure), which are allocated when one of their players
+ * makes the first move.
  */
 typedef struct Player {
     uint64_t busy_fields;
     uint64_t boundary_length;
+    game_field_t* frontier;
+    uint64_t frontier_length;
+    uint64_t frontier_capacity;
     uint32_t busy_areas;
-    char player_symbol;
+    bool frontier_mapped;
+    bool blocked;
 } player_t;
 
 // Describes the maximum number of the potential
 // neighbours for some field.
 #define MAX_NEIGHBOURS 4
 
+// Describes the width of the border of empty fields around the board
+// planes. Two fields are enough to read every neighbour and every
+// neighbour of a neighbour of a field without checking the coordinates.
+// The left and right borders share the same BORDER columns, because
+// the field (-1,y) lies just after the last field of the row y - 1.
+#define BORDER 2
+
 // Describes the first 9 players.
 #define FIRST_NINE_PLAYERS 9
 
 // Describes the first 35 players.
 #define FIRST_THIRTY_FIVE_PLAYERS 35
 
-// Describes the maximum possible number of players.
-#define MAX_PLAYERS 61
+// Describes the maximum number of players having one character symbols.
+// The fields of the games with more players are written as numbers
+// (see symbol_width in the game structure).
+#define MAX_SYMBOL_PLAYERS 61
+
+// Describes the maximum owner tag (see owner_t).
+#define MAX_OWNER_TAG UINT8_MAX
+
+// Describes the number of players in one page of the players table
+// (as a power of two).
+#define PLAYERS_PAGE_BITS 10
+#define PLAYERS_PAGE (1 << PLAYERS_PAGE_BITS)
+
+// Describes the number of words of the bitmap of the blocked players
+// of one page.
+#define PAGE_BITMAP_WORDS (PLAYERS_PAGE / 64)
+
+// Describes the maximum number of the levels of the bitmap of the full
+// pages: 2^22 pages of the players of the uint32_t numbers need 2^16,
+// 2^10, 2^4 and 1 words on its levels.
+#define MAX_FULL_LEVELS 4
+
+/** @brief A page of the players table:
+ * blocked       - the bitmap of the blocked players of the page: the bit
+ *                 i % 64 of blocked[i / 64] is set if the i-th player of
+ *                 the page is blocked (see player_t),
+ * blocked_count - the number of the blocked players of the page,
+ * players       - the players of the page.
+ */
+typedef struct Players_page {
+    uint64_t blocked[PAGE_BITMAP_WORDS];
+    uint32_t blocked_count;
+    player_t players[];
+} players_page_t;
+
+// Describes the initial capacity of the frontier array of a player.
+#define INITIAL_FRONTIER_CAPACITY 16
+
+// Describes how many taken fields the frontier array of a player may keep
+// above the number of its free fields before they are removed.
+#define FRONTIER_SLACK 16
+
+// Describes the number of bits in one word of the bitboards.
+#define BITBOARD_WORD 64
+
+// Describes how many words of the bitboards are computed at once
+// by the frontier kernels.
+#define FRONTIER_CHUNK_WORDS 256
+
+// Describes the length of the lookup table of the board symbols. It is
+// a multiple of 16 greater than MAX_SYMBOL_PLAYERS, so it is read by vector
+// instructions in parts of 16 symbols.
+#define SYMBOLS_LENGTH 64
+
+// Describes the length of the parts of the board text rendered at once
+// by game_board_write.
+#define BOARD_CHUNK_LENGTH (1 << 20)
+
+// Describes the maximum number of threads rendering the board text
+// in game_board_write.
+#define BOARD_WRITER_THREADS 8
+
+// Describes how many rendered parts of the board text game_board_write
+// keeps at once, so it never uses more than
+// BOARD_WRITER_SLOTS * BOARD_CHUNK_LENGTH bytes of buffers.
+#define BOARD_WRITER_SLOTS (2 * BOARD_WRITER_THREADS)
+
+// Describes how many moves ahead game_move_batch prefetches the board fields.
+#define MOVE_PREFETCH_DISTANCE 8
+
+// Describes the first bytes of the files written by game_save.
+#define SAVE_MAGIC "IPPGAME"
+
+// Describes the version of the format of the files written by game_save.
+#define SAVE_VERSION 3
+
+// Describes the number written in the files by game_save to recognise
+// the files written on a machine with another byte order.
+#define SAVE_BYTE_ORDER 0x01020304u
+
+// Describes the alignment of the board planes in the files written by
+// game_save, so they can be used in place in the file mapped to memory.
+#define SAVE_ALIGNMENT 4096
+
+// Describes the first bytes of the journals written by game_journal_start.
+#define JOURNAL_MAGIC "IPPMOVE"
+
+// Describes the version of the format of the journals.
+#define JOURNAL_VERSION 1
+
+// Describes the number of moves kept in the journal before they are encoded
+// and written in one block. The moves and the block fit in the L2 cache
+// together with the board fields used by the moves.
+#define JOURNAL_BLOCK_MOVES (1 << 13)
+
+// Describes the maximal length in bytes of one record of the journal: the tag
+// byte and three numbers of at most 4 bytes each.
+#define JOURNAL_MAX_RECORD 13
+
+// Describes the tag bit of the records of the journal which are not moves
+// and the kinds of these records (kept in the bits 1-6 of the tag).
+#define JOURNAL_EVENT 0x80
+#define JOURNAL_UNDO 1
+#define JOURNAL_REDO 2
+#define JOURNAL_HISTORY_ENABLE 3
+#define JOURNAL_HISTORY_DISABLE 4
+
+// Describes the constant of the checks of the entries of the transposition table.
+#define TABLE_CHECK 0x5bd1e9955bd1e995ULL
+
+// Describes the initial capacity of the arrays of the history of the moves.
+#define INITIAL_HISTORY_CAPACITY 64
+
+// Describes the number of changes of the disjoint-set forest reserved in
+// the history before a move. Union by size keeps the paths at most 32 colors
+// long, so this is usually enough for the whole move, but find_area reserves
+// the place for the colors it compresses itself (see find_area).
+#define MAX_MOVE_CHANGES (MAX_NEIGHBOURS * 32)
+
+// Describes the minimal length in bytes of the planes allocated with mmap.
+#define MIN_MAPPED_PLANE (1 << 21)
+
+// Describes the length of the side of a tile of the sparse board.
+#define TILE_SIDE 32
+
+// Describes the number of fields of a tile of the sparse board.
+#define TILE_FIELDS (TILE_SIDE * TILE_SIDE)
+
+// Describes the initial capacity of the hash table of the tiles.
+#define INITIAL_TILES_CAPACITY 16
+
+// Describes the maximum number of fields of a board created by game_new
+// in the dense planes. Larger boards are kept in tiles.
+#define MAX_DENSE_FIELDS ((uint64_t)1 << 31)
+
+// Describes the length of the side of the window of the fields read by
+// a move on the sparse board and the index of its middle field.
+#define WINDOW_SIDE 5
+#define WINDOW_MIDDLE (WINDOW_SIDE * WINDOW_SIDE / 2)
+
+// Describes the initial capacity of the area_parent and area_size arrays.
+#define INITIAL_AREAS_CAPACITY 64
+
+// Describes the maximum number of areas kept in area_parent array
+// before the numbers of areas are recycled (see compact_areas).
+#define MAX_AREAS_CAPACITY ((uint64_t)UINT32_MAX + 1)
+
+// Describes the maximum depth of a tree of the disjoint-set forest. A tree
+// built by union by size of depth d has at least 2^d colors and there are
+// less than MAX_AREAS_CAPACITY colors.
+#define MAX_AREA_DEPTH 32
+
+// Adds the value to the counter of the game or, if the engine is compiled
+// without GAME_STATS, only evaluates the value, so the counters cost nothing.
+#ifdef GAME_STATS
+#define COUNT(g, counter, value) ((g)->stats.counter += (value))
+#define COUNT_MAX(g, counter, value) \
+    ((g)->stats.counter = ((value) > (g)->stats.counter ? (value) : (g)->stats.counter))
+#else
+#define COUNT(g, counter, value) ((void)(value))
+#define COUNT_MAX(g, counter, value) ((void)(value))
+#endif
+
+/** @brief This structure describes the direct neighbours of the field taken
+ * in the current move. It is filled by update_structure and lives on the
+ * stack of the move, so nothing has to be reset between the moves.
+ * diff_pair_neighbour          - different (player_number, color) pairs of
+ *                                the non empty neighbours,
+ * diff_neighbour_number        - different player numbers of the non empty
+ *                                neighbours,
+ * free_neighbours              - the i-th bit is set if the i-th neighbour
+ *                                is inside the board and it is empty.
+ */
+typedef struct Neighbourhood {
+    pair_t diff_pair_neighbour[MAX_NEIGHBOURS];
+    uint32_t diff_neighbour_number[MAX_NEIGHBOURS];
+    uint32_t length_diff_pair_neighbour; ///< Length of diff_pair_neighbour.
+    uint32_t length_diff_neighbour_number; ///< Length of diff_neighbour_number.
+    uint32_t free_neighbours;
+} neighbourhood_t;
+
+/** @brief A tile of the sparse board: the owners and the colors of
+ * TILE_SIDE x TILE_SIDE fields kept row by row (see tile_offset).
+ * A tile is allocated when the first of its fields is taken. The games
+ * cloned from one game share their tiles (see game_clone) and other_games
+ * is the number of the other games sharing the tile. A shared tile is
+ * never changed, a game copies it before it takes a field of it.
+ */
+typedef struct Tile {
+    owner_t owners[TILE_FIELDS];
+    area_t colors[TILE_FIELDS];
+    atomic_uint other_games;
+} tile_t;
+
+// Describes the length in bytes of the fields of a tile.
+#define TILE_DATA_LENGTH offsetof(tile_t, other_games)
+
+/** @brief The planes of the dense board shared by the games cloned from
+ * one game (see game_clone). The planes are never changed; the games keep
+ * the changed fields in their tiles:
+ * owners, colors  - the planes (like in the game structure),
+ * plane_length    - the length of the planes,
+ * mapping         - NULL or the file mapped by game_load, which keeps
+ *                   the planes,
+ * mapping_length  - the length of the mapping,
+ * other_games     - the number of the games sharing the planes minus one.
+ */
+typedef struct Shared_planes {
+    owner_t* owners;
+    area_t* colors;
+    uint64_t plane_length;
+    void* mapping;
+    uint64_t mapping_length;
+    atomic_uint other_games;
+} shared_planes_t;
+
+/** @brief An entry of the hash table of the tiles. The entry is empty
+ * if tile is NULL and otherwise key is the tile_key of the tile.
+ */
+typedef struct Tile_entry {
+    uint64_t key;
+    tile_t* tile;
+} tile_entry_t;
+
+/** @brief The fields of the board read by a move: the owner and the color
+ * of the field of the move and the distances to its neighbours (the same as
+ * neighbour_offset and second_ring_offset in the game structure). On the dense
+ * board they point to the planes and on the sparse board to a window of
+ * the fields copied from the tiles.
+ */
+typedef struct Surroundings {
+    owner_t* owner;
+    area_t* color;
+    int64_t const* neighbour_offset;
+    int64_t const (*second_ring_offset)[MAX_NEIGHBOURS - 1];
+} surroundings_t;
+
+/** @brief The fields of the sparse board around the field of a move kept
+ * row by row like in the dense planes. Only the fields read by a move
+ * (at most two steps away from the middle one) are copied.
+ */
+typedef struct Window {
+    owner_t owners[WINDOW_SIDE * WINDOW_SIDE];
+    area_t colors[WINDOW_SIDE * WINDOW_SIDE];
+} window_t;
+
+// The neighbour_offset and second_ring_offset of the window.
+static const int64_t WINDOW_NEIGHBOUR_OFFSET[MAX_NEIGHBOURS] = {
+    1, -1, -WINDOW_SIDE, WINDOW_SIDE
+};
+static const int64_t WINDOW_SECOND_RING_OFFSET[MAX_NEIGHBOURS][MAX_NEIGHBOURS - 1] = {
+    {2, 1 - WINDOW_SIDE, 1 + WINDOW_SIDE},
+    {-2, -1 - WINDOW_SIDE, -1 + WINDOW_SIDE},
+    {1 - WINDOW_SIDE, -1 - WINDOW_SIDE, -2 * WINDOW_SIDE},
+    {1 + WINDOW_SIDE, -1 + WINDOW_SIDE, 2 * WINDOW_SIDE}
+};
+
+// Distances between the columns and the rows of a field and its right,
+// left, upper (y - 1) and lower (y + 1) neighbour.
+static const int32_t NEIGHBOUR_DX[MAX_NEIGHBOURS] = {1, -1, 0, 0};
+static const int32_t NEIGHBOUR_DY[MAX_NEIGHBOURS] = {0, 0, -1, 1};
+
+/** @brief The header of the journal. All numbers are kept in the byte
+ * order of the machine.
+ */
+typedef struct Journal_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t width;
+    uint32_t height;
+    uint32_t number_of_players;
+    uint32_t max_areas;
+} journal_header_t;
+
+/** @brief A move kept in the journal before it is encoded. The other records
+ * (see journal_event) have the kind of the record in the bits 1-6 of result.
+ */
+typedef struct Journal_move {
+    uint32_t player;
+    uint32_t x;
+    uint32_t y;
+    uint32_t result;
+} journal_move_t;
+
+/** @brief The journal of the moves (see game_journal_start). The moves are
+ * only copied to the moves array by game_move and they are encoded when the
+ * whole block is written, so the encoding does not slow down the moves:
+ * fd           - the file descriptor the journal is written to,
+ * failed       - true if writing failed (then the next blocks are dropped),
+ * error        - the errno of the failed writing,
+ * moves_count  - the number of moves in the moves array,
+ * length       - the number of bytes in the buffer before the records
+ *                (the header of the journal if it is not written yet),
+ * moves        - the moves not written yet,
+ * buffer       - the encoded block.
+ */
+typedef struct Journal {
+    int fd;
+    bool failed;
+    int error;
+    uint64_t moves_count;
+    uint64_t length;
+    journal_move_t moves[JOURNAL_BLOCK_MOVES];
+    uint8_t buffer[sizeof(journal_header_t) + JOURNAL_BLOCK_MOVES * JOURNAL_MAX_RECORD];
+} journal_t;
+
+/** @brief A change of the disjoint-set forest of the areas kept in the history
+ * of the moves: area_parent[area] was parent before the change. If parent
+ * is area, the root area was joined under another area.
+ */
+typedef struct Area_change {
+    area_t area;
+    area_t parent;
+} area_change_t;
+
+/** @brief A move kept in the history of the moves:
+ * player, x, y     - the parameters of the move,
+ * busy_areas       - the number of the areas of the player before the move,
+ * changes_length   - the length of the changes array after the move,
+ * new_frontier     - the mask of the neighbours added to the frontier
+ *                    of the player (see add_to_frontier),
+ * new_area         - true if the move created a new area.
+ */
+typedef struct History_move {
+    uint32_t player;
+    uint32_t x;
+    uint32_t y;
+    uint32_t busy_areas;
+    uint64_t changes_length;
+    uint8_t new_frontier;
+    bool new_area;
+} history_move_t;
+
+/** @brief The history of the moves (see game_history_enable). Undoing
+ * a move reverts the changes of the forest made since the previous move
+ * (also by the illegal moves, which compress the paths too):
+ * moves            - the made moves followed by the undone moves,
+ * moves_count      - the number of the made moves,
+ * moves_length     - the number of the made and the undone moves,
+ * moves_capacity   - the allocated length of moves array,
+ * changes          - the changes of the disjoint-set forest in their order,
+ * changes_length   - the length of changes array,
+ * changes_capacity - the allocated length of changes array.
+ */
+typedef struct History {
+    history_move_t* moves;
+    uint64_t moves_count;
+    uint64_t moves_length;
+    uint64_t moves_capacity;
+    area_change_t* changes;
+    uint64_t changes_length;
+    uint64_t changes_capacity;
+} history_t;
+
+/** @brief An entry of the transposition table. It keeps the value and
+ * the check: the xor of the hash, the value and TABLE_CHECK. The threads
+ * write the entries without locks, so an entry written by two threads
+ * at once may have the value of one and the check of the other; then its
+ * check is wrong and the entry is not found. The empty entry (filled with
+ * zeros) has the wrong check for every hash except TABLE_CHECK.
+ */
+typedef struct Table_entry {
+    _Atomic uint64_t check;
+    _Atomic uint64_t value;
+} table_entry_t;
+
+/** @brief The transposition table (see game_table_new). The entry of a hash
+ * is entries[hash & mask] and it keeps the last value stored for any hash
+ * with that index.
+ */
+struct game_table {
+    uint64_t mask;
+    table_entry_t* entries;
+};
 
 /** @brief This structure represents the whole game.
  * width                 - non negative number describing the width
@@ -63,116 +494,429 @@ typedef struct Player {
  * number_of_players     - non negative number representing the number of players,
  * max_areas             - non negative number representing the maximum
  *                         of free to take areas by each of the player,
- * game_board            - the matrix representing game status,
- * all_players           - the array of all players,
- * diff_pair_neighbour   - helper array holding for some coordinate (x,y) all
- *                         his different direct neighbours (neighbour_number, field_color),
- * diff_neighbour_number - helper array similar to diff_pair_neighbour but holding only
- *                         different neighhours player_numbers for some fixed (x,y) coordinate,
- * busy_neighbour_fields - number of direct neighbours for some (x,y) field,
- * fields_to_take        - non negative number of free fields in the game_board.
+ * stride                - the length of one row of the board planes (width + BORDER),
+ * owners                - the owners plane of the game board: owners[field_index(x,y)]
+ *                         is the owner tag of the field (x,y) or zero,
+ * colors                - the colors plane of the game board: colors[field_index(x,y)]
+ *                         is the color of the (non empty) field (x,y),
+ * tiles                 - NULL for the dense board kept in the owners and colors
+ *                         planes or the hash table of the tiles of the sparse
+ *                         board (then owners and colors are NULL),
+ * tiles_capacity        - the length of tiles array (a power of two),
+ * tiles_count           - the number of the allocated tiles,
+ * shared_planes         - NULL or the planes of the dense board shared with
+ *                         the cloned games (then the board is sparse and its
+ *                         missing tiles are read from the shared planes),
+ * neighbour_offset      - the distances in the board planes between a field and
+ *                         its right, left, upper (y - 1) and lower (y + 1) neighbour,
+ * second_ring_offset    - second_ring_offset[i] are the distances between a field
+ *                         and the neighbours of its i-th neighbour other than the field,
+ * player_pages          - the players table: player_pages[i] is NULL or the page
+ *                         of the players from i * PLAYERS_PAGE + 1 on (see
+ *                         read_player),
+ * full_pages            - the bitmap of the pages of the players table whose
+ *                         all players are blocked, kept in full_levels levels
+ *                         from full_offset[l] words on: the level 0 has full_bits[0]
+ *                         bits of the pages and the bit w of the level l + 1 is set
+ *                         if all bits of the word w of the level l are set. The bits
+ *                         after full_bits[l] are set, so the last words become full
+ *                         as the other ones (see next_not_full_page),
+ * blocked_players       - the number of the blocked players,
+ * fields_to_take        - non negative number of free fields in the game_board,
+ * area_parent           - the disjoint-set forest of area colors: area_parent[c]
+ *                         is the parent of the color c and the root of the tree
+ *                         is the color of the whole connected area,
+ * area_size             - area_size[c] is the number of colors in the tree
+ *                         rooted at c (used only for roots),
+ * area_owner            - NULL or, if the player numbers do not fit in the owner
+ *                         tags, area_owner[c] is the player number of the color c,
+ * areas_capacity        - the length of area_parent, area_size and area_owner arrays,
+ * next_area             - the number of the next created area,
+ * bitboards             - NULL or the packed bitboards of the board (see
+ *                         game_bitboards_enable): the plane 0 has the empty fields
+ *                         and the plane p the fields of the player p. The bit
+ *                         x % BITBOARD_WORD of the word bitboard_index(x,y)
+ *                         describes the field (x,y). Every row ends with one zero
+ *                         word and there is one zero row before and after the board,
+ *                         so the neighbours of every word can be read without checks,
+ * bitboard_stride       - the number of words in one row of the bitboards,
+ * bitboard_length       - the number of words in one plane of the bitboards,
+ * symbols               - symbols[p] is the symbol of the field with the owner p
+ *                         on the game board (the lookup table of game_board_into),
+ * symbol_width          - zero if the players have one character symbols and
+ *                         otherwise the number of digits of number_of_players:
+ *                         then every field is written as the player number of
+ *                         this width (see render_board_part),
+ * mapping               - NULL or the file mapped by game_load, which keeps
+ *                         the owners and colors planes,
+ * mapping_length        - the length of the mapping,
+ * journal               - NULL or the journal of the moves,
+ * history               - NULL or the history of the moves (see game_undo),
+ * hash                  - the Zobrist hash of the board: the xor of zobrist_key
+ *                         of all taken fields (see game_hash),
+ * stats                 - the counters of the engine (see game_stats), kept
+ *                         only if the engine is compiled with GAME_STATS.
  */
 struct game {
-    pair_t diff_pair_neighbour[MAX_NEIGHBOURS];
-    uint32_t diff_neighbour_number[MAX_NEIGHBOURS];
-    uint64_t length_diff_neighbour_number; ///< Length of diff_neighbour_number.
-    uint64_t busy_neighbour_fields;
     uint64_t fields_to_take;
-    uint64_t potential_neighbour_number; ///< Number of all "valid" neighbour coordinates.
     uint32_t width;
     uint32_t height;
     uint32_t number_of_players;
     uint32_t max_areas;
-    pair_t** game_board;
-    player_t* all_players;
+    uint64_t stride;
+    owner_t* owners;
+    area_t* colors;
+    tile_entry_t* tiles;
+    uint64_t tiles_capacity;
+    uint64_t tiles_count;
+    shared_planes_t* shared_planes;
+    int64_t neighbour_offset[MAX_NEIGHBOURS];
+    int64_t second_ring_offset[MAX_NEIGHBOURS][MAX_NEIGHBOURS - 1];
+    players_page_t** player_pages;
+    uint64_t* full_pages;
+    uint64_t full_offset[MAX_FULL_LEVELS];
+    uint64_t full_bits[MAX_FULL_LEVELS];
+    uint32_t full_levels;
+    uint32_t blocked_players;
+    area_t* area_parent;
+    area_t* area_size;
+    uint32_t* area_owner;
+    uint64_t areas_capacity;
+    uint64_t next_area;
+    uint64_t* bitboards;
+    uint64_t bitboard_stride;
+    uint64_t bitboard_length;
+    char symbols[SYMBOLS_LENGTH];
+    uint32_t symbol_width;
+    void* mapping;
+    uint64_t mapping_length;
+    journal_t* journal;
+    history_t* history;
+    uint64_t hash;
+#ifdef GAME_STATS
+    game_stats_t stats;
+#endif
 };
 
-// This constant is for coloring the connected fragments of fields of
-// the same figure number. In each iteration of game_move the
-// global counter will be increasing by 1.
-uint64_t GLOBAL_COUNTER = 1;
+// Allocates the plane of length bytes filled with zeros. The large planes
+// are mapped without reserving the memory and the kernel gives them zeroed
+// pages (huge pages if it can) only when they are touched for the first
+// time, so the time of the allocation does not depend on the length.
+// Returns NULL if there is no memory.
+static void* allocate_plane(uint64_t length) {
+    if (length < MIN_MAPPED_PLANE) {
+        return calloc(length, 1);
+    }
+
+    void* plane = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (plane == MAP_FAILED) {
+        errno = ENOMEM;
+
+        return NULL;
+    }
+
+#ifdef MADV_HUGEPAGE
+    madvise(plane, length, MADV_HUGEPAGE);
+#endif
+
+    return plane;
+}
+
+// Frees the plane of length bytes allocated with allocate_plane.
+static void free_plane(void* plane, uint64_t length) {
+    if (length < MIN_MAPPED_PLANE) {
+        free(plane);
+    }
+    else if (plane) {
+        munmap(plane, length);
+    }
+}
+
+// Frees the tile if no other game shares it and otherwise only stops
+// sharing it.
+static void release_tile(tile_t* tile) {
+    if (tile && (atomic_load(&tile->other_games) == 0 ||
+                 atomic_fetch_sub(&tile->other_games, 1) == 0)) {
+        free(tile);
+    }
+}
+
+// Frees the shared planes if no other game shares them and otherwise
+// only stops sharing them.
+static void release_shared_planes(shared_planes_t* planes) {
+    if (planes && (atomic_load(&planes->other_games) == 0 ||
+                   atomic_fetch_sub(&planes->other_games, 1) == 0)) {
+        if (planes->mapping) {
+            munmap(planes->mapping, planes->mapping_length);
+        }
+        else {
+            free_plane(planes->owners, planes->plane_length * sizeof(owner_t));
+            free_plane(planes->colors, planes->plane_length * sizeof(area_t));
+        }
+
+        free(planes);
+    }
+}
+
+// Returns the number of the pages of the players table.
+static uint64_t player_pages_count(game_t const* g) {
+    return ((uint64_t)g->number_of_players + PLAYERS_PAGE - 1) >> PLAYERS_PAGE_BITS;
+}
 
+// Returns the number of the players in the page of the players table.
+// Only the last page may be shorter than PLAYERS_PAGE.
+static uint64_t page_players(game_t const* g, uint64_t page) {
+    uint64_t first = page << PLAYERS_PAGE_BITS;
 
-static uint64_t min(uint64_t const x, uint64_t const y) {
-    return x <= y ? x : y;
+    return g->number_of_players - first < PLAYERS_PAGE ? g->number_of_players - first
+                                                       : PLAYERS_PAGE;
 }
 
 // An auxilary function for correct delete
 // malloced memory in game_new function.
-static void remove_struct(game_t* g, player_t* all_players, pair_t** first_row,
-                          pair_t* all_board) {
-    free(all_players);
-    free(all_board);
-    free(first_row);
+static void remove_struct(game_t* g, players_page_t** player_pages, uint64_t* full_pages,
+                          owner_t* owners, area_t* colors, uint64_t plane_length,
+                          tile_entry_t* tiles, area_t* area_parent, area_t* area_size,
+                          uint32_t* area_owner) {
+    for (uint64_t i = 0; g && player_pages && i < player_pages_count(g); i++) {
+        players_page_t* page = player_pages[i];
+
+        for (uint64_t j = 0; page && j < page_players(g, i); j++) {
+            if (!page->players[j].frontier_mapped) {
+                free(page->players[j].frontier);
+            }
+        }
+
+        free(page);
+    }
+
+    for (uint64_t i = 0; g && tiles && i < g->tiles_capacity; i++) {
+        release_tile(tiles[i].tile);
+    }
+
+    free(player_pages);
+    free(full_pages);
+    free_plane(owners, plane_length * sizeof(owner_t));
+    free_plane(colors, plane_length * sizeof(area_t));
+    free(tiles);
+    free(area_parent);
+    free(area_size);
+    free(area_owner);
     free(g);
 }
 
-game_t* game_new(uint32_t width, uint32_t height, uint32_t players, uint32_t areas) {
+// Returns the number of the decimal digits of the number.
+static uint32_t decimal_digits(uint32_t number) {
+    uint32_t digits = 1;
+
+    while (number >= 10) {
+        number /= 10;
+        digits++;
+    }
+
+    return digits;
+}
+
+// Returns the one character symbol of the player of the game with at most
+// MAX_SYMBOL_PLAYERS players. First 9 players have 1,...,9 as a player
+// symbol. Next players are denoted alphabetically (using small and large
+// letters).
+static char player_symbol(uint32_t player) {
+    if (player <= FIRST_NINE_PLAYERS) {
+        return (char)('0' + player);
+    }
+    else if (player <= FIRST_THIRTY_FIVE_PLAYERS) {
+        return (char)('a' + (player - 1 - FIRST_NINE_PLAYERS));
+    }
+
+    return (char)('A' + (player - 1 - FIRST_THIRTY_FIVE_PLAYERS));
+}
+
+// Sets the levels of the bitmap of the full pages of the game with the given
+// number of pages of the players table. Returns the number of its words.
+static uint64_t full_pages_layout(game_t* g, uint64_t pages) {
+    uint64_t words = 0;
+    uint64_t bits = pages;
+
+    g->full_levels = 0;
+
+    do {
+        g->full_offset[g->full_levels] = words;
+        g->full_bits[g->full_levels] = bits;
+        g->full_levels++;
+        bits = (bits + 63) / 64;
+        words += bits;
+    } while (bits > 1);
+
+    return words;
+}
+
+// Creates the game with the dense board kept in the planes or, if sparse
+// is true, with the sparse board kept in the tiles (see game_new).
+static game_t* new_game(uint32_t width, uint32_t height, uint32_t players,
+                        uint32_t areas, bool sparse) {
 
     // Firstly check if the input is correct.
-    if (width == 0 || height == 0 || players == 0 || areas == 0 || players > MAX_PLAYERS) {
+    if (width == 0 || height == 0 || players == 0 || areas == 0) {
         return NULL;
     }
 
     game_t* g = NULL;
-    player_t* all_players = NULL;
-    pair_t** game_board = NULL;
-    pair_t** first_row = NULL;
-    pair_t* all_board = NULL;
+    players_page_t** player_pages = NULL;
+    uint64_t* full_pages = NULL;
+    uint64_t pages = ((uint64_t)players + PLAYERS_PAGE - 1) >> PLAYERS_PAGE_BITS;
+    owner_t* owners = NULL;
+    area_t* colors = NULL;
+    tile_entry_t* tiles = NULL;
+    area_t* area_parent = NULL;
+    area_t* area_size = NULL;
+    uint32_t* area_owner = NULL;
+    uint64_t stride = (uint64_t)width + BORDER;
+    uint64_t plane_length = stride * ((uint64_t)height + 2 * BORDER);
 
+    // Both planes are flat arrays kept row by row together with
+    // the border. The border fields stay empty for the whole game.
+    // The sparse board has no planes and starts without any tile.
+    // The pages of the players table are allocated by their first moves.
     g = calloc(1, sizeof(game_t));
-    all_players = calloc(players, sizeof(player_t));
-    first_row = (pair_t**)malloc(width * sizeof(pair_t*));
-    all_board = (pair_t*)calloc((uint64_t)width * (uint64_t)height, sizeof(pair_t));
+    player_pages = calloc(pages, sizeof(players_page_t*));
 
-    if (!g || !all_players || !first_row || !all_board) {
-        remove_struct(g, all_players, first_row, all_board);
+    if (g) {
+        full_pages = calloc(full_pages_layout(g, pages), sizeof(uint64_t));
+    }
 
-        return NULL;
+    if (sparse) {
+        tiles = calloc(INITIAL_TILES_CAPACITY, sizeof(tile_entry_t));
+    }
+    else {
+        owners = (owner_t*)allocate_plane(plane_length * sizeof(owner_t));
+        colors = (area_t*)allocate_plane(plane_length * sizeof(area_t));
     }
 
-    for (uint32_t i = 0; i < width; i++) {
-        first_row[i] = &all_board[(uint64_t)i * (uint64_t)height];
+    area_parent = (area_t*)malloc(INITIAL_AREAS_CAPACITY * sizeof(area_t));
+    area_size = (area_t*)malloc(INITIAL_AREAS_CAPACITY * sizeof(area_t));
+
+    if (players > MAX_OWNER_TAG) {
+        area_owner = malloc(INITIAL_AREAS_CAPACITY * sizeof(uint32_t));
     }
 
-    game_board = first_row;
+    if (!g || !player_pages || !full_pages || (sparse ? !tiles : !owners || !colors) ||
+        !area_parent || !area_size || (players > MAX_OWNER_TAG && !area_owner)) {
+        remove_struct(g, player_pages, full_pages, owners, colors, plane_length, tiles,
+                      area_parent, area_size, area_owner);
 
-    // First 9 players will have 1,...,9 as a player symbol.
-    // Next players are denoted alphabetically (using large
-    // and small letters).
-    for (uint32_t i = 0; i < players; i++) {
-        if (i < FIRST_NINE_PLAYERS) {
-            all_players[i].player_symbol = (char)('1' + i);
-        }
-        else if (i >= FIRST_NINE_PLAYERS && i < FIRST_THIRTY_FIVE_PLAYERS) {
-            all_players[i].player_symbol = (char)('a' + (i - FIRST_NINE_PLAYERS));
+        return NULL;
+    }
+
+    // The bits after the last page and the last words are set, so they
+    // are never found as not full.
+    for (uint32_t level = 0; level < g->full_levels; level++) {
+        uint64_t bits = g->full_bits[level];
+
+        if (bits % 64 != 0) {
+            full_pages[g->full_offset[level] + bits / 64] |= UINT64_MAX << (bits % 64);
         }
-        else {
-            all_players[i].player_symbol = (char)('A' + (i - FIRST_THIRTY_FIVE_PLAYERS));
+    }
+
+    // The symbols of the owners which are not players are never used.
+    memset(g->symbols, '.', SYMBOLS_LENGTH);
+
+    if (players <= MAX_SYMBOL_PLAYERS) {
+        for (uint32_t i = 1; i <= players; i++) {
+            g->symbols[i] = player_symbol(i);
         }
     }
+    else {
+        g->symbol_width = decimal_digits(players);
+    }
 
     // The game creating.
     g->width = width;
     g->height = height;
     g->number_of_players = players;
     g->max_areas = areas;
-    g->game_board = game_board;
-    g->all_players = all_players;
+    g->stride = stride;
+    g->owners = owners;
+    g->colors = colors;
+    g->tiles = tiles;
+    g->tiles_capacity = sparse ? INITIAL_TILES_CAPACITY : 0;
+    g->player_pages = player_pages;
+    g->full_pages = full_pages;
     g->fields_to_take = (uint64_t)width * (uint64_t)height;
+    g->area_parent = area_parent;
+    g->area_size = area_size;
+    g->area_owner = area_owner;
+    g->areas_capacity = INITIAL_AREAS_CAPACITY;
+    g->next_area = 1;
+
+    // Right, left, upper and lower neighbour. The neighbour opposite
+    // to the i-th one is the (i ^ 1)-th one.
+    g->neighbour_offset[0] = 1;
+    g->neighbour_offset[1] = -1;
+    g->neighbour_offset[2] = -(int64_t)stride;
+    g->neighbour_offset[3] = (int64_t)stride;
 
-    // Always set GLOBAL_COUNTER to 1 when new_game is created.
-    GLOBAL_COUNTER = 1;
+    for (int i = 0; i < MAX_NEIGHBOURS; i++) {
+        int position = 0;
+
+        for (int j = 0; j < MAX_NEIGHBOURS; j++) {
+            if (j != (i ^ 1)) {
+                g->second_ring_offset[i][position] = g->neighbour_offset[i] +
+                                                     g->neighbour_offset[j];
+                position++;
+            }
+        }
+    }
 
     return g;
 }
 
+// Returns the length of the board planes together with the border.
+static uint64_t plane_length(game_t const* g) {
+    return g->stride * ((uint64_t)g->height + 2 * BORDER);
+}
+
+// Returns the length in bytes of all planes of the bitboards.
+static uint64_t bitboards_length(game_t const* g) {
+    return ((uint64_t)g->number_of_players + 1) * g->bitboard_length * sizeof(uint64_t);
+}
+
+game_t* game_new(uint32_t width, uint32_t height, uint32_t players, uint32_t areas) {
+    return new_game(width, height, players, areas,
+                    (uint64_t)width * height > MAX_DENSE_FIELDS);
+}
+
+game_t* game_new_sparse(uint32_t width, uint32_t height, uint32_t players,
+                        uint32_t areas) {
+    return new_game(width, height, players, areas, true);
+}
+
 void game_delete(game_t* g) {
     if (g) {
-        pair_t** first_row = g->game_board;
-        pair_t* all_board = g->game_board[0];
+        if (g->journal) {
+            game_journal_stop(g);
+        }
 
-        remove_struct(g, g->all_players, first_row, all_board);
+        game_history_disable(g);
+
+        // The planes of the loaded game are a part of the mapped file.
+        if (g->mapping) {
+            munmap(g->mapping, g->mapping_length);
+            g->owners = NULL;
+            g->colors = NULL;
+        }
+
+        // The tiles are released before the planes, so the last game sharing
+        // the planes does not share any tile (see unshare_planes).
+        shared_planes_t* planes = g->shared_planes;
+
+        free_plane(g->bitboards, bitboards_length(g));
+        remove_struct(g, g->player_pages, g->full_pages, g->owners, g->colors,
+                      plane_length(g), g->tiles, g->area_parent, g->area_size,
+                      g->area_owner);
+        release_shared_planes(planes);
     }
 }
 
@@ -181,487 +925,3409 @@ static bool correct_player_number(game_t const* g, uint32_t const player_number)
     return (!(player_number == 0 || player_number > g->number_of_players));
 }
 
-// Returns true if the player occupied all possible aries and false otherwise.
-static bool player_occupied_all_areas(game_t const* g, uint32_t const player_number) {
-    return (g->all_players[player_number - 1].busy_areas == g->max_areas);
-}
+// The player of the pages of the players table which are not allocated.
+static player_t const EMPTY_PLAYER;
 
-// Returns true if the coordinate is valid and false otherwise.
-static bool correct_coordinate(game_t const* g, uint32_t const x, uint32_t const y) {
-    return (!(x >= g->width || y >= g->height));
+// Returns the player with the correct number. If his page of the players
+// table is not allocated, he has not moved yet and the empty player is returned.
+static player_t const* read_player(game_t const* g, uint32_t const player_number) {
+    players_page_t const* page = g->player_pages[(player_number - 1) >> PLAYERS_PAGE_BITS];
+
+    return page ? &page->players[(player_number - 1) & (PLAYERS_PAGE - 1)] : &EMPTY_PLAYER;
 }
 
-// Returns true if the coordinate (x,y) is already occupied and false otherwise.
-static bool empty_coordinate(game_t const* g, uint32_t const x, uint32_t const y) {
-    return (g->game_board[x][y].player_number == 0);
+// Returns the player with the correct number, whose page of the players
+// table is allocated (like the pages of all players having figures).
+static player_t* find_player(game_t* g, uint32_t const player_number) {
+    players_page_t* page = g->player_pages[(player_number - 1) >> PLAYERS_PAGE_BITS];
+
+    return &page->players[(player_number - 1) & (PLAYERS_PAGE - 1)];
 }
 
-// Helper function in update_structure procedure which is adding the new pair to array.
-static void add_to_array(int* position, pair_t* neighbours, pair_t value_to_add,
-                         uint64_t* length) {
-    for (int i = 0; i < *position; i++) {
-        if (neighbours[i].player_number == value_to_add.player_number &&
-            neighbours[i].color == value_to_add.color) {
-            return;
+// Returns the player with the correct number allocating his page of
+// the players table if it is needed. Returns NULL if there is no memory.
+static player_t* get_player(game_t* g, uint32_t const player_number) {
+    uint64_t page = (player_number - 1) >> PLAYERS_PAGE_BITS;
+
+    if (!g->player_pages[page]) {
+        g->player_pages[page] = calloc(1, sizeof(players_page_t) +
+                                          page_players(g, page) * sizeof(player_t));
+
+        if (!g->player_pages[page]) {
+            return NULL;
         }
     }
 
-    neighbours[*position].player_number = value_to_add.player_number;
-    neighbours[*position].color = value_to_add.color;
-    (*position)++;
-    (*length)++;
+    return find_player(g, player_number);
 }
 
-// Working with neighbours of (x,y) coordinate.
-// Update all g members which depend on (x,y) coordinate in the
-// definition.
-static void update_structure(game_t* g, uint32_t x, uint32_t y) {
-    uint64_t length_diff_pair_neighbour = 0;
-    uint64_t length_diff_neighbour_number = 0;
-    uint64_t busy_neighbour_fields = 0;
-    uint64_t potential_neighbour_number = 0;
-    bool valid_right = correct_coordinate(g, x + 1, y);
-    bool valid_left = correct_coordinate(g, x - 1, y);
-    bool valid_down = correct_coordinate(g, x, y + 1);
-    bool valid_up = correct_coordinate(g, x, y - 1);
-    int position = 0;
+// Returns true if the player occupied all possible aries and false otherwise.
+static bool player_occupied_all_areas(game_t const* g, uint32_t const player_number) {
+    return (read_player(g, player_number)->busy_areas == g->max_areas);
+}
 
-    // Update the array diff_pair_neighbour and busy_neighbour_fields,
-    // Update the length_diff_pair_neighbour.
-    if (valid_right) {
-        potential_neighbour_number++;
+// Sets the bit of the page in the bitmap of the full pages if full is true
+// and clears it otherwise. The bits of the upper levels are changed while
+// their words become full or stop being full.
+static void set_full_page(game_t* g, uint64_t page, bool full) {
+    uint64_t index = page;
 
-        if (!empty_coordinate(g, x + 1, y)) {
-            busy_neighbour_fields++;
-            add_to_array(&position, g->diff_pair_neighbour,
-                         g->game_board[x + 1][y], &length_diff_pair_neighbour);
-        }
-    }
-    if (valid_left) {
-        potential_neighbour_number++;
+    for (uint32_t level = 0; level < g->full_levels; level++) {
+        uint64_t* word = &g->full_pages[g->full_offset[level] + index / 64];
+        bool was_full = *word == UINT64_MAX;
 
-        if (!empty_coordinate(g, x - 1, y)) {
-            busy_neighbour_fields++;
-            add_to_array(&position, g->diff_pair_neighbour,
-                         g->game_board[x - 1][y], &length_diff_pair_neighbour);
+        if (full) {
+            *word |= (uint64_t)1 << (index % 64);
         }
-    }
-    if (valid_up) {
-        potential_neighbour_number++;
-
-        if (!empty_coordinate(g, x, y - 1)) {
-            busy_neighbour_fields++;
-            add_to_array(&position, g->diff_pair_neighbour,
-                         g->game_board[x][y - 1], &length_diff_pair_neighbour);
+        else {
+            *word &= ~((uint64_t)1 << (index % 64));
         }
-    }
-    if (valid_down) {
-        potential_neighbour_number++;
 
-        if (!empty_coordinate(g, x, y + 1)) {
-            busy_neighbour_fields++;
-            add_to_array(&position, g->diff_pair_neighbour,
-                         g->game_board[x][y + 1], &length_diff_pair_neighbour);
+        if ((*word == UINT64_MAX) == was_full) {
+            break;
         }
+
+        index /= 64;
     }
+}
 
-    // Update the g.diff_neighbour_numbers.
-    bool copy;
+// Updates the blocked flag of the player who has moved after his busy_areas
+// or boundary_length changed, together with the bitmap of his page and
+// the bitmap of the full pages.
+static void update_blocked(game_t* g, uint32_t const player_number) {
+    player_t* p = find_player(g, player_number);
+    bool blocked = p->busy_areas == g->max_areas && p->boundary_length == 0;
 
-    for (uint64_t i = 0; i < length_diff_pair_neighbour; i++) {
-        copy = false;
+    if (blocked == p->blocked) {
+        return;
+    }
 
-        for (uint64_t z = 0; z < length_diff_neighbour_number; z++) {
-            if (g->diff_pair_neighbour[i].player_number == g->diff_neighbour_number[z]) {
-                copy = true;
-                break;
-            }
-        }
+    uint64_t page_number = (player_number - 1) >> PLAYERS_PAGE_BITS;
+    uint64_t offset = (player_number - 1) & (PLAYERS_PAGE - 1);
+    players_page_t* page = g->player_pages[page_number];
+    bool was_full = page->blocked_count == page_players(g, page_number);
 
-        if (!copy) {
-            g->diff_neighbour_number[length_diff_neighbour_number] =
-                    g->diff_pair_neighbour[i].player_number;
-            length_diff_neighbour_number++;
-        }
+    p->blocked = blocked;
+    page->blocked[offset / 64] ^= (uint64_t)1 << (offset % 64);
+
+    if (blocked) {
+        page->blocked_count++;
+        g->blocked_players++;
+    }
+    else {
+        page->blocked_count--;
+        g->blocked_players--;
     }
 
-    g->length_diff_neighbour_number = length_diff_neighbour_number;
-    g->busy_neighbour_fields = busy_neighbour_fields;
-    g->potential_neighbour_number = potential_neighbour_number;
+    if (was_full != (page->blocked_count == page_players(g, page_number))) {
+        set_full_page(g, page_number, !was_full);
+    }
 }
 
-/** @brief Checks if adding new figure generates a new area for the player.
- * @param[in] neighbours      - is the array of diff_pair_neighbour of the player,
- * @param[in] player_number   - the player number.
- * @return true if adding creates the new area and false otherwise.
- */
-static bool boundary_adding(pair_t const* neighbours, uint32_t const player_number) {
-    int i = 0;
+// Returns the offset of the first player of the page who is not blocked
+// from the given offset on or PLAYERS_PAGE if there is none. The players
+// of the pages which are not allocated have not moved, so they are not
+// blocked. The offsets after the last player of the page are not checked.
+static uint64_t page_unblocked(game_t const* g, uint64_t page_number, uint64_t offset) {
+    players_page_t const* page = g->player_pages[page_number];
 
-    while (neighbours[i].player_number != 0 && i < 4) {
-        if (neighbours[i].player_number == player_number) {
-            return true;
+    if (!page) {
+        return offset;
+    }
+
+    for (uint64_t word = offset / 64; word < PAGE_BITMAP_WORDS; word++) {
+        uint64_t unblocked = ~page->blocked[word];
+
+        if (word == offset / 64) {
+            unblocked &= UINT64_MAX << (offset % 64);
+        }
+
+        if (unblocked != 0) {
+            return word * 64 + (uint64_t)__builtin_ctzll(unblocked);
         }
-        i++;
     }
 
-    return false;
+    return PLAYERS_PAGE;
 }
 
-/** @brief An auxilary function which analyses free neighbour cell
- *  of the coordinate c := (x,y) and add +1 to the answer if that
- *  field has its own neighbour (different that c) with the
- *  same figure number as in c.
- * @param[in] g               - pointer to the game structure,
- * @param[in] x               - column number,
- * @param[in] y               - row number,
- * @param[in] player_number   - the number of the figure we put at (x,y) coordinate.
- * @return The number of empty diff_pair_neighbour of the (x,y) coordinate which has
- * in their own diff_pair_neighbour the player_number.
- */
-static uint64_t check_non_direct_neighbours(game_t const* g, uint32_t x,
-                                            uint32_t y, uint32_t player_number) {
-    uint64_t answer = 0;
-    bool valid_left = correct_coordinate(g, x - 1, y);
-    bool valid_right = correct_coordinate(g, x + 1, y);
-    bool valid_up = correct_coordinate(g, x, y - 1);
-    bool valid_down = correct_coordinate(g, x, y + 1);
+// Returns the number of the first page from the given one on which has
+// a player who is not blocked or UINT64_MAX if there is none. The search
+// goes up the levels of the bitmap of the full pages while the rest of
+// the word is full and then down to the page, so it reads at most two
+// words of every level.
+static uint64_t next_not_full_page(game_t const* g, uint64_t page) {
+    uint64_t index = page;
+    uint32_t level = 0;
 
-    // Define 3 bool variables for checking the validity of
-    // non direct variables ("neighbours" of my neighbour).
-    bool technical1;
-    bool technical2;
-    bool technical3;
+    while (true) {
+        if (level == g->full_levels || index >= g->full_bits[level]) {
+            return UINT64_MAX;
+        }
 
-    if (valid_left && empty_coordinate(g, x - 1, y)) {
-        technical1 = correct_coordinate(g, x - 2, y);
-        technical2 = correct_coordinate(g, x - 1, y + 1);
-        technical3 = correct_coordinate(g, x - 1, y - 1);
+        uint64_t not_full = ~g->full_pages[g->full_offset[level] + index / 64] &
+                            (UINT64_MAX << (index % 64));
 
-        if ((technical1 && g->game_board[x - 2][y].player_number == player_number) ||
-            (technical2 && g->game_board[x - 1][y + 1].player_number == player_number) ||
-            (technical3 && g->game_board[x - 1][y - 1].player_number == player_number)) {
-            answer++;
+        if (not_full != 0) {
+            index = index / 64 * 64 + (uint64_t)__builtin_ctzll(not_full);
+            break;
         }
-    }
-    if (valid_right && empty_coordinate(g, x + 1, y)) {
-        technical1 = correct_coordinate(g, x + 2, y);
-        technical2 = correct_coordinate(g, x + 1, y - 1);
-        technical3 = correct_coordinate(g, x + 1, y + 1);
 
-        if ((technical1 && g->game_board[x + 2][y].player_number == player_number) ||
-            (technical2 && g->game_board[x + 1][y - 1].player_number == player_number) ||
-            (technical3 && g->game_board[x + 1][y + 1].player_number == player_number)) {
-            answer++;
-        }
+        index = index / 64 + 1;
+        level++;
     }
-    if (valid_up && empty_coordinate(g, x, y - 1)) {
-        technical1 = correct_coordinate(g, x, y - 2);
-        technical2 = correct_coordinate(g, x - 1, y - 1);
-        technical3 = correct_coordinate(g, x + 1, y - 1);
 
-        if ((technical1 && g->game_board[x][y - 2].player_number == player_number) ||
-            (technical2 && g->game_board[x - 1][y - 1].player_number == player_number) ||
-            (technical3 && g->game_board[x + 1][y - 1].player_number == player_number)) {
-            answer++;
-        }
+    while (level > 0) {
+        level--;
+        index = index * 64 +
+                (uint64_t)__builtin_ctzll(~g->full_pages[g->full_offset[level] + index]);
     }
-    if (valid_down && empty_coordinate(g, x, y + 1)) {
-        technical1 = correct_coordinate(g, x, y + 2);
-        technical2 = correct_coordinate(g, x - 1, y + 1);
-        technical3 = correct_coordinate(g, x + 1, y + 1);
 
-        if ((technical1 && g->game_board[x][y + 2].player_number == player_number) ||
-            (technical2 && g->game_board[x - 1][y + 1].player_number == player_number) ||
-            (technical3 && g->game_board[x + 1][y + 1].player_number == player_number)) {
-            answer++;
+    return index;
+}
+
+// Returns the number of the first player who is not blocked from the player
+// number first + 1 on or zero if there is none.
+static uint32_t first_unblocked(game_t const* g, uint64_t first) {
+    uint64_t page = first >> PLAYERS_PAGE_BITS;
+    uint64_t offset = page_unblocked(g, page, first & (PLAYERS_PAGE - 1));
+
+    if (offset >= page_players(g, page)) {
+        page = next_not_full_page(g, page + 1);
+
+        if (page == UINT64_MAX) {
+            return 0;
         }
+
+        offset = page_unblocked(g, page, 0);
     }
 
-    return answer;
+    return (uint32_t)((page << PLAYERS_PAGE_BITS) + offset + 1);
 }
 
-// Reset all auxilary data in game structure to zero.
-static void set_to_zero(game_t* g) {
-    for (int i = 0; i < 4; i++) {
-        g->diff_pair_neighbour[i].player_number = 0;
-        g->diff_pair_neighbour[i].color = 0;
-        g->diff_neighbour_number[i] = 0;
-    }
+// Returns the owner tag of the fields of the player: the player number
+// if it is at most MAX_OWNER_TAG and otherwise one of the tags. Then
+// the player number of the field is kept in area_owner.
+static owner_t owner_tag(uint32_t const player_number) {
+    return (owner_t)(player_number <= MAX_OWNER_TAG ? player_number
+                                                   : (player_number - 1) % MAX_OWNER_TAG + 1);
 }
 
-// Looks at all direct busy neighbour fields having player_number figure
-// on it and returns their minimum color.
-static uint64_t find_min_color(game_t const* g, uint32_t player_number) {
-    uint64_t answer = UINT64_MAX;
+// Returns true if the coordinate is valid and false otherwise.
+static bool correct_coordinate(game_t const* g, uint32_t const x, uint32_t const y) {
+    return (!(x >= g->width || y >= g->height));
+}
 
-    for (int i = 0; i < 4; i++) {
-        if (g->diff_pair_neighbour[i].player_number == player_number) {
-            answer = min(answer, g->diff_pair_neighbour[i].color);
-        }
-    }
+// Returns the index of the coordinate (x,y) in the planes of the game board.
+static uint64_t field_index(game_t const* g, uint32_t const x, uint32_t const y) {
+    return ((uint64_t)y + BORDER) * g->stride + x;
+}
 
-    return answer;
+// Returns the index of the word describing the coordinate (x,y) in one
+// plane of the bitboards.
+static uint64_t bitboard_index(game_t const* g, uint32_t const x, uint32_t const y) {
+    return ((uint64_t)y + 1) * g->bitboard_stride + x / BITBOARD_WORD;
 }
 
-// Recursive function for recoloring different fragments of the same
-// player. The parameter min_color describes the new color of that fragments.
-static void BFS(game_t* g, uint32_t x, uint32_t y, uint64_t min_color,
-                uint64_t player_number) {
-    if (!correct_coordinate(g, x, y)) {
-        return;
-    }
+// Marks the field (x,y) as taken by the player in the bitboards.
+static void set_bitboard_field(game_t* g, uint32_t player, uint32_t x, uint32_t y) {
+    uint64_t index = bitboard_index(g, x, y);
+    uint64_t bit = (uint64_t)1 << (x % BITBOARD_WORD);
 
-    if (g->game_board[x][y].player_number == player_number &&
-        g->game_board[x][y].color != min_color) {
-        g->game_board[x][y].color = min_color;
-        BFS(g, x + 1, y, min_color, player_number);
-        BFS(g, x - 1, y, min_color, player_number);
-        BFS(g, x, y - 1, min_color, player_number);
-        BFS(g, x, y + 1, min_color, player_number);
-    }
+    g->bitboards[index] &= ~bit;
+    g->bitboards[player * g->bitboard_length + index] |= bit;
 }
 
-bool game_move(game_t* g, uint32_t player, uint32_t x, uint32_t y) {
-    if (!g || !correct_player_number(g, player) || !correct_coordinate(g, x, y) ||
-        g->game_board[x][y].player_number != 0) {
-        return false;
-    }
+// Marks the field (x,y) taken by the player as empty in the bitboards.
+static void clear_bitboard_field(game_t* g, uint32_t player, uint32_t x, uint32_t y) {
+    uint64_t index = bitboard_index(g, x, y);
+    uint64_t bit = (uint64_t)1 << (x % BITBOARD_WORD);
 
-    /**
-     * We split next part of that function on two cases:
-     * (1) the move is "boundary" i.e. adding the figure
-     * does not create new area,
-     * (2) the move creates new area.
-     */
-    update_structure(g, x, y);
+    g->bitboards[index] |= bit;
+    g->bitboards[player * g->bitboard_length + index] &= ~bit;
+}
 
-    if (!boundary_adding(g->diff_pair_neighbour, player)) {
-        if (player_occupied_all_areas(g, player)) {
-            return false;
+
+// Returns the Zobrist key of the field (x,y) taken by the player. The keys
+// are not kept in a table, which would have a key for every player and
+// every field, but computed by mixing the bits of the parameters with
+// the finalizer of splitmix64.
+static uint64_t zobrist_key(uint32_t player, uint32_t x, uint32_t y) {
+    uint64_t key = ((uint64_t)x << 32 | y) * 0x9e3779b97f4a7c15ULL +
+                   (uint64_t)player * 0xd1b54a32d192ed03ULL;
+
+    key = (key ^ key >> 30) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ key >> 27) * 0x94d049bb133111ebULL;
+
+    return key ^ key >> 31;
+}
+
+// Returns the key of the tile containing the coordinate (x,y).
+static uint64_t tile_key(uint32_t const x, uint32_t const y) {
+    return (uint64_t)(x / TILE_SIDE) << 32 | (y / TILE_SIDE);
+}
+
+// Returns the index of the coordinate (x,y) in the arrays of its tile.
+static uint64_t tile_offset(uint32_t const x, uint32_t const y) {
+    return (uint64_t)(y % TILE_SIDE) * TILE_SIDE + x % TILE_SIDE;
+}
+
+// Returns the position of the entry of the tile with the given key in
+// the hash table of the tiles or of the empty entry where it should be.
+static uint64_t tile_position(tile_entry_t const* tiles, uint64_t capacity,
+                              uint64_t key) {
+    uint64_t hash = key * 0x9E3779B97F4A7C15ULL;
+    uint64_t position = (hash ^ hash >> 32) & (capacity - 1);
+
+    while (tiles[position].tile && tiles[position].key != key) {
+        position = (position + 1) & (capacity - 1);
+    }
+
+    return position;
+}
+
+// Returns the tile containing the coordinate (x,y) or NULL if no field
+// of that tile is taken yet.
+static tile_t* find_tile(game_t const* g, uint32_t const x, uint32_t const y) {
+    return g->tiles[tile_position(g->tiles, g->tiles_capacity, tile_key(x, y))].tile;
+}
+
+// Doubles the hash table of the tiles. Returns false if there is no memory.
+static bool grow_tiles(game_t* g) {
+    uint64_t new_capacity = 2 * g->tiles_capacity;
+    tile_entry_t* tiles = calloc(new_capacity, sizeof(tile_entry_t));
+
+    if (!tiles) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < g->tiles_capacity; i++) {
+        if (g->tiles[i].tile) {
+            tiles[tile_position(tiles, new_capacity, g->tiles[i].key)] = g->tiles[i];
         }
+    }
 
-        // Update current player.
-        g->all_players[player - 1].busy_areas++;
-        g->all_players[player - 1].busy_fields++;
-        g->all_players[player - 1].boundary_length += g->potential_neighbour_number -
-                                                      g->busy_neighbour_fields -
-                                                      check_non_direct_neighbours(g, x, y, player);
-
-        // Update the game structure and the GLOBAL_COUNTER.
-        g->game_board[x][y].player_number = player;
-        g->game_board[x][y].color = GLOBAL_COUNTER;
-        GLOBAL_COUNTER++;
-        g->fields_to_take--;
+    free(g->tiles);
+    g->tiles = tiles;
+    g->tiles_capacity = new_capacity;
+
+    return true;
+}
+
+// Copies the fields of the tile containing the coordinate (x,y) from
+// the shared planes. The fields outside of the board stay empty.
+static void copy_shared_fields(game_t const* g, tile_t* tile, uint32_t x, uint32_t y) {
+    uint32_t first_x = x / TILE_SIDE * TILE_SIDE;
+    uint32_t first_y = y / TILE_SIDE * TILE_SIDE;
+    uint32_t columns = g->width - first_x < TILE_SIDE ? g->width - first_x : TILE_SIDE;
+
+    for (uint32_t row = first_y; row < g->height && row < first_y + TILE_SIDE; row++) {
+        uint64_t index = field_index(g, first_x, row);
+        uint64_t offset = tile_offset(first_x, row);
+
+        memcpy(&tile->owners[offset], &g->shared_planes->owners[index],
+               columns * sizeof(owner_t));
+        memcpy(&tile->colors[offset], &g->shared_planes->colors[index],
+               columns * sizeof(area_t));
+    }
+}
+
+// Returns the tile containing the coordinate (x,y), which can be changed
+// by the game. The tile is allocated if it does not exist yet and copied
+// if it is shared with another game. Returns NULL if there is no memory
+// for it.
+static tile_t* get_tile(game_t* g, uint32_t const x, uint32_t const y) {
+    uint64_t key = tile_key(x, y);
+    uint64_t position = tile_position(g->tiles, g->tiles_capacity, key);
+    tile_t* shared = g->tiles[position].tile;
+
+    if (shared && atomic_load(&shared->other_games) == 0) {
+        return shared;
+    }
 
-        // Update all non empty diff_pair_neighbour.
-        uint32_t helper_variable;
+    if (shared) {
+        tile_t* tile = malloc(sizeof(tile_t));
 
-        for (uint64_t i = 0; i < g->length_diff_neighbour_number; i++) {
-            helper_variable = g->diff_neighbour_number[i];
-            g->all_players[helper_variable - 1].boundary_length--;
+        if (!tile) {
+            return NULL;
         }
+
+        memcpy(tile, shared, TILE_DATA_LENGTH);
+        atomic_init(&tile->other_games, 0);
+        release_tile(shared);
+        g->tiles[position].tile = tile;
+
+        return tile;
     }
-    else {
-        uint64_t min_color = find_min_color(g, player);
-        uint32_t fragments = 0;
 
-        // Firstly find the number of neighbours with the same number.
-        for (int i = 0; i < 4; i++) {
-            if (g->diff_pair_neighbour[i].player_number == player) {
-                fragments++;
-            }
+    // The table is kept at most half full.
+    if (2 * (g->tiles_count + 1) > g->tiles_capacity) {
+        if (!grow_tiles(g)) {
+            return NULL;
         }
 
-        // Update me.
-        g->all_players[player - 1].busy_areas -= fragments - 1;
-        g->all_players[player - 1].busy_fields++;
-        g->all_players[player - 1].boundary_length += g->potential_neighbour_number -
-                                                      g->busy_neighbour_fields -
-                                                      check_non_direct_neighbours(g, x, y, player);
-
-        // Update the game structure and the GLOBAL_COUNTER.
-        g->game_board[x][y].player_number = player;
-        g->game_board[x][y].color = min_color;
-        GLOBAL_COUNTER++;
-        g->fields_to_take--;
+        position = tile_position(g->tiles, g->tiles_capacity, key);
+    }
+
+    tile_t* tile = calloc(1, sizeof(tile_t));
+
+    if (!tile) {
+        return NULL;
+    }
 
-        // Update all diff_pair_neighbour with different figures.
-        int z = 0;
-        uint32_t local_number; // Helper in next while loop.
+    if (g->shared_planes) {
+        copy_shared_fields(g, tile, x, y);
+    }
 
-        while (z < 4 && g->diff_neighbour_number[z] != 0) {
-            local_number = g->diff_neighbour_number[z];
-            g->all_players[local_number - 1].boundary_length--;
+    g->tiles[position].key = key;
+    g->tiles[position].tile = tile;
+    g->tiles_count++;
 
-            z++;
-        }
+    return tile;
+}
 
-        // Update all diff_pair_neighbour with the same number by recoloring them.
-        BFS(g, x + 1, y, min_color, player);
-        BFS(g, x - 1, y, min_color, player);
-        BFS(g, x, y - 1, min_color, player);
-        BFS(g, x, y + 1, min_color, player);
+// Returns the owner tag of the field (x,y) or zero if it is empty.
+static owner_t field_owner(game_t const* g, uint32_t const x, uint32_t const y) {
+    if (!g->tiles) {
+        return g->owners[field_index(g, x, y)];
     }
 
-    set_to_zero(g);
+    tile_t const* tile = find_tile(g, x, y);
 
-    return true;
+    if (tile) {
+        return tile->owners[tile_offset(x, y)];
+    }
+
+    return g->shared_planes ? g->shared_planes->owners[field_index(g, x, y)] : 0;
 }
 
-uint64_t game_busy_fields(game_t const* g, uint32_t player) {
-    if (!g || !correct_player_number(g, player)) {
-        return 0;
+// Returns the color of the non empty field (x,y).
+static area_t field_color(game_t const* g, uint32_t const x, uint32_t const y) {
+    if (!g->tiles) {
+        return g->colors[field_index(g, x, y)];
     }
 
-    return g->all_players[player - 1].busy_fields;
+    tile_t const* tile = find_tile(g, x, y);
+
+    return tile ? tile->colors[tile_offset(x, y)]
+                : g->shared_planes->colors[field_index(g, x, y)];
 }
 
-uint64_t game_free_fields(game_t const* g, uint32_t player) {
-    if (!g || !correct_player_number(g, player)) {
-        return 0;
+// Returns the player number of the field (x,y) or zero if it is empty.
+static uint32_t field_player(game_t const* g, uint32_t const x, uint32_t const y) {
+    owner_t owner = field_owner(g, x, y);
+
+    if (owner == 0 || !g->area_owner) {
+        return owner;
     }
-    if (player_occupied_all_areas(g, player)) {
-        return g->all_players[player - 1].boundary_length;
+
+    return g->area_owner[field_color(g, x, y)];
+}
+
+// Returns true if the field (x,y) is empty and false otherwise.
+static bool empty_field(game_t const* g, uint32_t const x, uint32_t const y) {
+    return (field_owner(g, x, y) == 0);
+}
+
+// Sets s to the fields read by the move at (x,y). On the sparse board the
+// fields at most two steps away from (x,y) are copied to the window first
+// (from the tiles or, if they are missing, from the shared planes) and
+// the fields outside of the board stay empty like the border of the planes.
+static void read_surroundings(game_t* g, uint32_t x, uint32_t y, window_t* window,
+                              surroundings_t* s) {
+    if (!g->tiles) {
+        uint64_t index = field_index(g, x, y);
+
+        s->owner = &g->owners[index];
+        s->color = &g->colors[index];
+        s->neighbour_offset = g->neighbour_offset;
+        s->second_ring_offset = g->second_ring_offset;
+
+        return;
     }
 
-    return g->fields_to_take;
+    memset(window, 0, sizeof(window_t));
+
+    for (int64_t dy = -2; dy <= 2; dy++) {
+        for (int64_t dx = -2; dx <= 2; dx++) {
+            int64_t column = (int64_t)x + dx;
+            int64_t row = (int64_t)y + dy;
+
+            if (llabs(dx) + llabs(dy) > 2 || column < 0 || row < 0 ||
+                column >= g->width || row >= g->height) {
+                continue;
+            }
+
+            tile_t const* tile = find_tile(g, (uint32_t)column, (uint32_t)row);
+            owner_t const* owners = NULL;
+            area_t const* colors = NULL;
+            uint64_t offset = 0;
+
+            if (tile) {
+                owners = tile->owners;
+                colors = tile->colors;
+                offset = tile_offset((uint32_t)column, (uint32_t)row);
+            }
+            else if (g->shared_planes) {
+                owners = g->shared_planes->owners;
+                colors = g->shared_planes->colors;
+                offset = field_index(g, (uint32_t)column, (uint32_t)row);
+            }
+
+            // The colors of the empty fields are never read.
+            if (owners && owners[offset] != 0) {
+                int64_t index = WINDOW_MIDDLE + dy * WINDOW_SIDE + dx;
+
+                window->owners[index] = owners[offset];
+                window->colors[index] = colors[offset];
+            }
+        }
+    }
+
+    s->owner = &window->owners[WINDOW_MIDDLE];
+    s->color = &window->colors[WINDOW_MIDDLE];
+    s->neighbour_offset = WINDOW_NEIGHBOUR_OFFSET;
+    s->second_ring_offset = WINDOW_SECOND_RING_OFFSET;
 }
 
-uint64_t game_general_free_fields(game_t const* g) {
-    return g->fields_to_take;
+// Makes sure that count more changes of the forest fit in the history.
+// Returns false if there is no memory.
+static bool reserve_changes(history_t* h, uint64_t count) {
+    uint64_t needed = h->changes_length + count;
+
+    if (needed <= h->changes_capacity) {
+        return true;
+    }
+
+    uint64_t new_capacity = 2 * h->changes_capacity < needed ? needed : 2 * h->changes_capacity;
+    area_change_t* changes = realloc(h->changes, new_capacity * sizeof(area_change_t));
+
+    if (!changes) {
+        return false;
+    }
+
+    h->changes = changes;
+    h->changes_capacity = new_capacity;
+
+    return true;
 }
 
-uint32_t game_board_width(game_t const *g) {
-    if (!g) {
-        return 0;
+// Adds the change of area_parent[area] from parent to the history of
+// the moves, if it is kept. There has to be a place for it (see find_area
+// and reserve_history).
+static void record_area_change(game_t* g, area_t area, area_t parent) {
+    if (g->history) {
+        history_t* h = g->history;
+
+        h->changes[h->changes_length] = (area_change_t){.area = area, .parent = parent};
+        h->changes_length++;
+    }
+}
+
+// Returns the color of the whole area containing the color c. Every
+// color visited on the way is linked directly to the root (path compression).
+static area_t find_area(game_t* g, area_t c) {
+    area_t root = c;
+    uint64_t steps = 0;
+
+    while (g->area_parent[root] != root) {
+        root = g->area_parent[root];
+        steps++;
     }
 
-    return g->width;
+    COUNT(g, find_steps, steps);
+    COUNT_MAX(g, longest_find, steps);
+
+    // The history needs a place for the compressed colors and for the joins
+    // of the areas made later by the move, whatever the depth of the forest.
+    // Without memory for them the path is left as it is, which only makes
+    // the next search longer.
+    if (g->history && !reserve_changes(g->history, steps + MAX_NEIGHBOURS)) {
+        return root;
+    }
+
+    while (g->area_parent[c] != root) {
+        area_t next = g->area_parent[c];
+        record_area_change(g, c, next);
+        g->area_parent[c] = root;
+        c = next;
+    }
+
+    return root;
 }
 
-uint32_t game_board_height(game_t const *g) {
-    if (!g) {
-        return 0;
+// Joins two different areas given by their roots. The smaller tree is
+// attached under the bigger one (union by size). Returns the new root.
+static area_t union_areas(game_t* g, area_t first_root, area_t second_root) {
+    if (g->area_size[first_root] < g->area_size[second_root]) {
+        area_t helper = first_root;
+        first_root = second_root;
+        second_root = helper;
     }
 
-    return g->height;
+    record_area_change(g, second_root, second_root);
+    g->area_parent[second_root] = first_root;
+    g->area_size[first_root] += g->area_size[second_root];
+
+    return first_root;
 }
 
-uint32_t game_areas(game_t const* g) {
-    return g->max_areas;
+// Gives every non empty field of the arrays the number kept in area_size
+// for the root of its area (see compact_areas).
+static void relabel_areas(game_t* g, owner_t const* owners, area_t* colors,
+                          uint64_t length) {
+    for (uint64_t i = 0; i < length; i++) {
+        if (owners[i] != 0) {
+            colors[i] = g->area_size[find_area(g, colors[i])];
+        }
+    }
 }
 
-uint32_t game_players(game_t const *g) {
-    if (!g) {
-        return 0;
+// Makes all tiles of the sparse board changeable by the game: copies
+// the shared tiles and, if the game shares the planes, copies all fields
+// of the board from them to the tiles and stops sharing the planes.
+// Returns false if there is no memory.
+static bool own_all_tiles(game_t* g) {
+    if (g->shared_planes) {
+        for (uint64_t y = 0; y < g->height; y += TILE_SIDE) {
+            for (uint64_t x = 0; x < g->width; x += TILE_SIDE) {
+                if (!get_tile(g, (uint32_t)x, (uint32_t)y)) {
+                    return false;
+                }
+            }
+        }
+
+        release_shared_planes(g->shared_planes);
+        g->shared_planes = NULL;
+
+        return true;
     }
 
-    return g->number_of_players;
+    for (uint64_t i = 0; i < g->tiles_capacity; i++) {
+        uint64_t key = g->tiles[i].key;
+
+        if (g->tiles[i].tile && !get_tile(g, (uint32_t)(key >> 32) * TILE_SIDE,
+                                          (uint32_t)(key & UINT32_MAX) * TILE_SIDE)) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
-char game_player(game_t const* g, uint32_t player) {
-    if (!g || !correct_player_number(g, player)) {
-        return '.';
+// Makes the board dense again when the game is the last one sharing
+// the planes: copies the fields of its tiles to the planes, frees the tiles
+// and takes the planes over. The other games released their tiles before
+// the planes (see game_delete), so no tile is shared any more.
+static void unshare_planes(game_t* g) {
+    shared_planes_t* planes = g->shared_planes;
+
+    if (!planes || atomic_load(&planes->other_games) != 0) {
+        return;
+    }
+
+    for (uint64_t i = 0; i < g->tiles_capacity; i++) {
+        tile_t* tile = g->tiles[i].tile;
+
+        if (!tile) {
+            continue;
+        }
+
+        uint32_t first_x = (uint32_t)(g->tiles[i].key >> 32) * TILE_SIDE;
+        uint32_t first_y = (uint32_t)(g->tiles[i].key & UINT32_MAX) * TILE_SIDE;
+        uint32_t columns = g->width - first_x < TILE_SIDE ? g->width - first_x : TILE_SIDE;
+
+        for (uint32_t row = first_y; row < g->height && row < first_y + TILE_SIDE; row++) {
+            uint64_t index = field_index(g, first_x, row);
+            uint64_t offset = tile_offset(first_x, row);
+
+            memcpy(&planes->owners[index], &tile->owners[offset], columns * sizeof(owner_t));
+            memcpy(&planes->colors[index], &tile->colors[offset], columns * sizeof(area_t));
+        }
+
+        release_tile(tile);
     }
 
-    return g->all_players[player - 1].player_symbol;
+    free(g->tiles);
+    g->tiles = NULL;
+    g->tiles_capacity = 0;
+    g->tiles_count = 0;
+    g->owners = planes->owners;
+    g->colors = planes->colors;
+    g->mapping = planes->mapping;
+    g->mapping_length = planes->mapping_length;
+    g->shared_planes = NULL;
+    free(planes);
 }
 
-char* game_board(game_t const *g) {
-    if (!g) {
-        return NULL;
+// Recycles the numbers of areas which were joined to other areas.
+// Every non empty field gets the number of the root of its area and
+// the roots are renumbered to 1, 2, ... in their order. The area_size
+// array keeps the new numbers of the roots in the meantime. Returns false
+// if there is no memory for the tiles shared with other games.
+static bool compact_areas(game_t* g) {
+    if (g->tiles && !own_all_tiles(g)) {
+        return false;
     }
 
-    uint64_t size = ((uint64_t)g->width + 1) * (uint64_t )g->height + 1;
-    char* board = (char*)malloc(size * sizeof(char));
-    uint64_t local_index = 0;
-    uint32_t player_number;
+    // The moves made before cannot be undone, because the areas get new
+    // numbers, so the changes of the forest are not kept.
+    history_t* history = g->history;
 
-    if (!board) {
-        return NULL;
+    g->history = NULL;
+
+    if (history) {
+        history->moves_count = 0;
+        history->moves_length = 0;
+        history->changes_length = 0;
     }
 
-    for (uint32_t i = g->height; i-- > 0;) {
-        for (uint32_t j = 0; j < g->width; j++) {
-            player_number = g->game_board[j][i].player_number;
+    COUNT(g, compactions, 1);
 
-            if (player_number == 0) {
-                board[local_index] = '.';
-            }
-            else {
-                board[local_index] = g->all_players[player_number - 1].player_symbol;
+    uint64_t roots = 0;
+
+    for (uint64_t i = 1; i < g->next_area; i++) {
+        if (g->area_parent[i] == i) {
+            roots++;
+            g->area_size[i] = (area_t)roots;
+
+            // The new number is not greater than i, so the players of
+            // the roots after i are not overwritten.
+            if (g->area_owner) {
+                g->area_owner[roots] = g->area_owner[i];
             }
+        }
+    }
+
+    if (!g->tiles) {
+        relabel_areas(g, g->owners, g->colors, plane_length(g));
+    }
 
-            local_index++;
+    for (uint64_t i = 0; i < g->tiles_capacity; i++) {
+        if (g->tiles[i].tile) {
+            relabel_areas(g, g->tiles[i].tile->owners, g->tiles[i].tile->colors,
+                          TILE_FIELDS);
         }
+    }
 
-        board[local_index] = '\n';
-        local_index++;
+    for (uint64_t i = 1; i <= roots; i++) {
+        g->area_parent[i] = (area_t)i;
+        g->area_size[i] = 1;
     }
 
-    board[size - 1] = '\0';
+    g->next_area = roots + 1;
+    g->history = history;
 
-    return board;
+    return true;
 }
 
-/** @brief  Checks if the player can make any move on the game
- * board. This function is an auxiliary function in find_next_player
- * function.
- * @param g                 - pointer on the game structure.
- * @param player_number     - number of observed player.
- * @return True if the player can make any move and false otherwise.
- */
-static bool player_available(game_t* g, uint32_t player_number) {
-    if (game_free_fields(g, player_number) > 0) {
+// Makes sure that the area number next_area fits in area_parent and
+// area_size arrays. Returns false if there is no memory for them.
+static bool reserve_area(game_t* g) {
+    if (g->next_area < g->areas_capacity) {
         return true;
     }
 
-    return false;
-}
+    if (g->next_area == MAX_AREAS_CAPACITY) {
+        return compact_areas(g) && g->next_area < g->areas_capacity;
+    }
 
-bool find_next_player(game_t* g, uint32_t* current_player_number) {
-    uint32_t find_next = *current_player_number;
+    uint64_t new_capacity = 2 * g->areas_capacity;
+    area_t* area_parent = realloc(g->area_parent, new_capacity * sizeof(area_t));
 
-    // If the next player is found then this variable is true.
-    bool search_success = false;
+    if (!area_parent) {
+        return false;
+    }
+
+    g->area_parent = area_parent;
+
+    area_t* area_size = realloc(g->area_size, new_capacity * sizeof(area_t));
 
-    // Set find_next to the next player after current_player_number.
-    if (find_next == game_players(g)) {
-        find_next = 1;
+    if (!area_size) {
+        return false;
     }
-    else {
-        find_next++;
+
+    g->area_size = area_size;
+
+    if (g->area_owner) {
+        uint32_t* area_owner = realloc(g->area_owner, new_capacity * sizeof(uint32_t));
+
+        if (!area_owner) {
+            return false;
+        }
+
+        g->area_owner = area_owner;
     }
 
-    // Find next available player for making a move.
-    while (find_next != *current_player_number) {
-        if (player_available(g, find_next)) {
-            *current_player_number = find_next;
-            search_success = true;
+    g->areas_capacity = new_capacity;
 
-            return search_success;
+    return true;
+}
+
+// Helper function in update_structure procedure which is adding the new pair to array.
+static void add_to_array(pair_t* neighbours, uint32_t* length, pair_t value_to_add) {
+    for (uint32_t i = 0; i < *length; i++) {
+        if (neighbours[i].player_number == value_to_add.player_number &&
+            neighbours[i].color == value_to_add.color) {
+            return;
         }
-        else if (find_next == game_players(g)) {
-            find_next = 1;
+    }
+
+    neighbours[*length] = value_to_add;
+    (*length)++;
+}
+
+// Returns the neighbour field with the given owner and color with its color
+// replaced by the color of the whole area it belongs to.
+static pair_t neighbour_area(game_t* g, owner_t owner, area_t color) {
+    pair_t neighbour;
+
+    neighbour.player_number = g->area_owner ? g->area_owner[color] : owner;
+    neighbour.color = find_area(g, color);
+
+    return neighbour;
+}
+
+// Working with neighbours of (x,y) coordinate with the surroundings s.
+// Fills the neighbourhood n which depends on (x,y) coordinate in the
+// definition. The fields outside of the board are empty, so only
+// the mask of the neighbours inside the board needs the coordinates.
+static void update_structure(game_t* g, neighbourhood_t* n, surroundings_t const* s,
+                             uint32_t x, uint32_t y) {
+    n->length_diff_pair_neighbour = 0;
+    n->length_diff_neighbour_number = 0;
+    n->free_neighbours = 0;
+
+    // Update the array diff_pair_neighbour and free_neighbours.
+    for (int i = 0; i < MAX_NEIGHBOURS; i++) {
+        int64_t offset = s->neighbour_offset[i];
+
+        if (s->owner[offset] == 0) {
+            n->free_neighbours |= 1u << i;
         }
         else {
-            find_next++;
+            add_to_array(n->diff_pair_neighbour, &n->length_diff_pair_neighbour,
+                         neighbour_area(g, s->owner[offset], s->color[offset]));
         }
     }
 
-    // If there is no available players except of
-    // current_player_number we need to check him again.
-    if (player_available(g, *current_player_number)) {
-        search_success = true;
+    // Update the diff_neighbour_number.
+    bool copy;
+
+    for (uint32_t i = 0; i < n->length_diff_pair_neighbour; i++) {
+        copy = false;
+
+        for (uint32_t z = 0; z < n->length_diff_neighbour_number; z++) {
+            if (n->diff_pair_neighbour[i].player_number == n->diff_neighbour_number[z]) {
+                copy = true;
+                break;
+            }
+        }
+
+        if (!copy) {
+            n->diff_neighbour_number[n->length_diff_neighbour_number] =
+                    n->diff_pair_neighbour[i].player_number;
+            n->length_diff_neighbour_number++;
+        }
     }
 
-    return search_success;
+    n->free_neighbours &= (uint32_t)(x + 1 < g->width) | (uint32_t)(x > 0) << 1 |
+                          (uint32_t)(y > 0) << 2 | (uint32_t)(y + 1 < g->height) << 3;
 }
 
-void print_players_score(game_t* g) {
-    for (uint32_t i = 0; i < game_players(g); i++) {
-        printf("Player %c occupied %lu field(s) and %u area(s)\n",
-               g->all_players[i].player_symbol, g->all_players[i].busy_fields, g->all_players[i].busy_areas);
+/** @brief Checks if adding new figure does not generate a new area for the player.
+ * @param[in] n               - the neighbourhood of the field,
+ * @param[in] player_number   - the player number.
+ * @return true if adding joins the field to some area of the player
+ * and false if it creates the new area.
+ */
+static bool boundary_adding(neighbourhood_t const* n, uint32_t const player_number) {
+    for (uint32_t i = 0; i < n->length_diff_neighbour_number; i++) {
+        if (n->diff_neighbour_number[i] == player_number) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** @brief An auxilary function which analyses free neighbour cell
+ *  of the coordinate c := (x,y) and marks it in the answer if that
+ *  field has its own neighbour (different that c) with the
+ *  same figure number as in c. A field outside of the board is
+ *  empty and has only empty neighbours different than c, so it
+ *  is never marked and every field is read without a branch.
+ * @param[in] s               - the surroundings of the (x,y) coordinate,
+ * @param[in] player_number   - the number of the figure we put at (x,y) coordinate.
+ * @return The mask of empty neighbours of the (x,y) coordinate which have
+ * the player_number among their own neighbours (the i-th bit describes
+ * the i-th neighbour).
+ */
+static uint32_t check_non_direct_neighbours(surroundings_t const* s,
+                                            uint32_t player_number) {
+    owner_t const* field = s->owner;
+    uint32_t answer = 0;
+
+    for (int i = 0; i < MAX_NEIGHBOURS; i++) {
+        int64_t const* ring = s->second_ring_offset[i];
+        bool empty = (field[s->neighbour_offset[i]] == 0);
+        bool touches = (field[ring[0]] == player_number) |
+                       (field[ring[1]] == player_number) |
+                       (field[ring[2]] == player_number);
+
+        answer |= (uint32_t)(empty & touches) << i;
+    }
+
+    return answer;
+}
+
+// The same as check_non_direct_neighbours in the games whose player numbers
+// do not fit in the owner tags: the fields with the tag of the player are
+// compared by their player numbers kept in area_owner.
+static uint32_t check_non_direct_players(game_t const* g, surroundings_t const* s,
+                                         uint32_t player_number) {
+    owner_t const* field = s->owner;
+    owner_t tag = owner_tag(player_number);
+    uint32_t answer = 0;
+
+    for (int i = 0; i < MAX_NEIGHBOURS; i++) {
+        int64_t const* ring = s->second_ring_offset[i];
+
+        if (field[s->neighbour_offset[i]] != 0) {
+            continue;
+        }
+
+        for (int j = 0; j < MAX_NEIGHBOURS - 1; j++) {
+            if (field[ring[j]] == tag && g->area_owner[s->color[ring[j]]] == player_number) {
+                answer |= 1u << i;
+            }
+        }
+    }
+
+    return answer;
+}
+
+// Joins all areas of player_number which are direct neighbours of
+// the current field (x,y) and returns the color of the joined area.
+static area_t join_neighbour_areas(game_t* g, neighbourhood_t const* n,
+                                   uint32_t player_number) {
+    area_t root = 0;
+
+    for (uint32_t i = 0; i < n->length_diff_pair_neighbour; i++) {
+        if (n->diff_pair_neighbour[i].player_number == player_number) {
+            if (root == 0) {
+                root = n->diff_pair_neighbour[i].color;
+            }
+            else {
+                root = union_areas(g, root, n->diff_pair_neighbour[i].color);
+            }
+        }
+    }
+
+    return root;
+}
+
+// Makes sure that MAX_NEIGHBOURS new fields fit in the frontier array
+// of the player. Returns false if there is no memory for them.
+static bool reserve_frontier(player_t* p) {
+    if (p->frontier_length + MAX_NEIGHBOURS <= p->frontier_capacity) {
+        return true;
+    }
+
+    // The copied frontiers are exactly as long as needed, so the doubled
+    // capacity is not enough for the new fields if it is small.
+    uint64_t new_capacity = 2 * p->frontier_capacity;
+
+    if (new_capacity < INITIAL_FRONTIER_CAPACITY) {
+        new_capacity = INITIAL_FRONTIER_CAPACITY;
+    }
+
+    game_field_t* frontier;
+
+    if (p->frontier_mapped) {
+        frontier = malloc(new_capacity * sizeof(game_field_t));
+
+        if (frontier) {
+            memcpy(frontier, p->frontier, p->frontier_length * sizeof(game_field_t));
+        }
+    }
+    else {
+        frontier = realloc(p->frontier, new_capacity * sizeof(game_field_t));
+    }
+
+    if (!frontier) {
+        return false;
+    }
+
+    p->frontier = frontier;
+    p->frontier_capacity = new_capacity;
+    p->frontier_mapped = false;
+
+    return true;
+}
+
+// Adds the neighbours of the field (x,y) given by the mask to the frontier
+// array of the player. There has to be a place for them (see reserve_frontier).
+static void add_to_frontier(player_t* p, uint32_t mask, uint32_t x, uint32_t y) {
+    for (int i = 0; i < MAX_NEIGHBOURS; i++) {
+        if (mask & (1u << i)) {
+            p->frontier[p->frontier_length].x = x + NEIGHBOUR_DX[i];
+            p->frontier[p->frontier_length].y = y + NEIGHBOUR_DY[i];
+            p->frontier_length++;
+        }
+    }
+}
+
+// Removes the taken fields from the frontier array of the player if
+// they outnumber its free fields. Every field is removed once, so the
+// amortised cost of a move stays constant.
+// The frontier is not shrunk while the history of the moves is kept, because
+// undoing a move removes the fields it added from the end of the frontier.
+static void shrink_frontier(game_t const* g, player_t* p) {
+    if (p->frontier_length <= 2 * p->boundary_length + FRONTIER_SLACK || g->history) {
+        return;
+    }
+
+    uint64_t length = 0;
+
+    for (uint64_t i = 0; i < p->frontier_length; i++) {
+        if (empty_field(g, p->frontier[i].x, p->frontier[i].y)) {
+            p->frontier[length] = p->frontier[i];
+            length++;
+        }
+    }
+
+    p->frontier_length = length;
+}
+
+// Makes sure that the next move and all changes of the forest made by it
+// fit in the arrays of the history. Returns false if there is no memory.
+static bool reserve_history(history_t* h) {
+    if (h->moves_count == h->moves_capacity) {
+        uint64_t new_capacity = 2 * h->moves_capacity;
+        history_move_t* moves = realloc(h->moves, new_capacity * sizeof(history_move_t));
+
+        if (!moves) {
+            return false;
+        }
+
+        h->moves = moves;
+        h->moves_capacity = new_capacity;
+    }
+
+    return reserve_changes(h, MAX_MOVE_CHANGES);
+}
+
+// Returns true if the player number and the coordinate (x,y) are correct
+// and the field (x,y) is empty. Checks them with a single branch.
+static bool correct_move(game_t const* g, uint32_t player, uint32_t x, uint32_t y) {
+    bool correct = correct_player_number(g, player) & correct_coordinate(g, x, y);
+
+    return correct && empty_field(g, x, y);
+}
+
+// Puts the figure of the player on the empty field (x,y). The parameters
+// have to be already checked. Returns false if the move is illegal.
+static bool make_move(game_t* g, uint32_t player, uint32_t x, uint32_t y) {
+    player_t* me = get_player(g, player);
+
+    if (!me) {
+        return false;
+    }
+
+    unshare_planes(g);
+
+    uint32_t busy_areas = me->busy_areas;
+    tile_t* tile = NULL;
+    window_t window;
+    surroundings_t s;
+    neighbourhood_t n;
+
+    // The history keeps also the changes of the forest made by reading
+    // the neighbours, so it has to have a place for them before.
+    if (g->history && !reserve_history(g->history)) {
+        return false;
+    }
+
+    /**
+     * We split next part of that function on two cases:
+     * (1) the move is "boundary" i.e. adding the figure
+     * does not create new area,
+     * (2) the move creates new area.
+     */
+    read_surroundings(g, x, y, &window, &s);
+    update_structure(g, &n, &s, x, y);
+
+    bool boundary = boundary_adding(&n, player);
+    bool all_areas = !boundary && player_occupied_all_areas(g, player);
+
+    COUNT(g, areas_failures, all_areas);
+
+    // Everything what can fail is checked before the game is changed.
+    if (all_areas || (!boundary && !reserve_area(g)) ||
+        !reserve_frontier(me) || (g->tiles && !(tile = get_tile(g, x, y)))) {
+        return false;
+    }
+
+    // The free neighbours of the field which were not on the boundary
+    // of the player yet.
+    uint32_t touching = g->area_owner ? check_non_direct_players(g, &s, player)
+                                      : check_non_direct_neighbours(&s, player);
+    uint32_t new_frontier = n.free_neighbours & ~touching;
+
+    if (!boundary) {
+        // Update current player.
+        me->busy_areas++;
+        me->busy_fields++;
+
+        // Update the game structure. The new field gets the number
+        // of the new area.
+        area_t color = (area_t)g->next_area;
+
+        *s.owner = owner_tag(player);
+        *s.color = color;
+        g->area_parent[color] = color;
+        g->area_size[color] = 1;
+        g->next_area++;
+        g->fields_to_take--;
+        COUNT(g, new_areas, 1);
+
+        if (g->area_owner) {
+            g->area_owner[color] = player;
+        }
+    }
+    else {
+        uint32_t fragments = 0;
+
+        // Firstly find the number of neighbours with the same number.
+        for (uint32_t i = 0; i < n.length_diff_pair_neighbour; i++) {
+            if (n.diff_pair_neighbour[i].player_number == player) {
+                fragments++;
+            }
+        }
+
+        // Update me.
+        me->busy_areas -= fragments - 1;
+        me->busy_fields++;
+        COUNT(g, merging_moves, fragments > 1);
+        COUNT(g, merged_areas, fragments - 1);
+
+        // Update the game structure. All neighbour areas with the same
+        // number are joined in the disjoint-set forest instead of recoloring
+        // their fields, so the cost does not depend on the size of the areas.
+        *s.owner = owner_tag(player);
+        *s.color = join_neighbour_areas(g, &n, player);
+        g->fields_to_take--;
+    }
+
+    // The sparse board keeps the field in its tile, not in the window.
+    if (tile) {
+        tile->owners[tile_offset(x, y)] = *s.owner;
+        tile->colors[tile_offset(x, y)] = *s.color;
+    }
+
+    if (g->bitboards) {
+        set_bitboard_field(g, player, x, y);
+    }
+
+    g->hash ^= zobrist_key(player, x, y);
+    COUNT(g, made_moves, 1);
+    me->boundary_length += (uint32_t)__builtin_popcount(new_frontier);
+    add_to_frontier(me, new_frontier, x, y);
+
+    // The field is no longer free for the players having figures next to it.
+    for (uint32_t i = 0; i < n.length_diff_neighbour_number; i++) {
+        player_t* neighbour = find_player(g, n.diff_neighbour_number[i]);
+
+        neighbour->boundary_length--;
+        shrink_frontier(g, neighbour);
+        update_blocked(g, n.diff_neighbour_number[i]);
+    }
+
+    update_blocked(g, player);
+
+    if (g->history) {
+        history_t* h = g->history;
+
+        // The move forgets the undone moves, so they cannot be redone.
+        h->moves[h->moves_count] = (history_move_t){
+            .player = player, .x = x, .y = y, .busy_areas = busy_areas,
+            .changes_length = h->changes_length, .new_frontier = (uint8_t)new_frontier,
+            .new_area = !boundary
+        };
+        h->moves_count++;
+        h->moves_length = h->moves_count;
+    }
+
+    return true;
+}
+
+// Writes all iov_length buffers of the iov array to the file descriptor.
+// Returns false if writing failed.
+static bool write_all(int fd, struct iovec* iov, int iov_length) {
+    while (iov_length > 0) {
+        ssize_t written = writev(fd, iov, iov_length);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        // Skip the written buffers and the written part of the next one.
+        while (iov_length > 0 && (size_t)written >= iov->iov_len) {
+            written -= (ssize_t)iov->iov_len;
+            iov++;
+            iov_length--;
+        }
+
+        if (iov_length > 0) {
+            iov->iov_base = (char*)iov->iov_base + written;
+            iov->iov_len -= (size_t)written;
+        }
+    }
+
+    return true;
+}
+
+// Returns the number of the lowest bytes of the number which are not all zero,
+// but at least one.
+static int number_bytes(uint32_t value) {
+    return (32 - __builtin_clz(value | 1) + 7) / 8;
+}
+
+// Writes the number to out in the little endian byte order. All 4 bytes are
+// written, but only the first bytes of them are a part of the record.
+static void encode_number(uint8_t* out, uint32_t value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    memcpy(out, &value, sizeof(uint32_t));
+}
+
+// Writes the record of the move to out. Returns the end of the record.
+static uint8_t* encode_move(uint8_t* out, journal_move_t const* move) {
+    if (move->result > 1) {
+        out[0] = (uint8_t)(JOURNAL_EVENT | move->result);
+
+        return out + 1;
+    }
+
+    int player_bytes = number_bytes(move->player);
+    int x_bytes = number_bytes(move->x);
+    int y_bytes = number_bytes(move->y);
+
+    out[0] = (uint8_t)(move->result | (player_bytes - 1) << 1 | (x_bytes - 1) << 3 |
+                       (y_bytes - 1) << 5);
+    out++;
+    encode_number(out, move->player);
+    out += player_bytes;
+    encode_number(out, move->x);
+    out += x_bytes;
+    encode_number(out, move->y);
+
+    return out + y_bytes;
+}
+
+// Encodes the moves kept in the journal and writes them in one block.
+static void flush_journal(journal_t* j) {
+    uint8_t* out = &j->buffer[j->length];
+
+    for (uint64_t i = 0; i < j->moves_count; i++) {
+        out = encode_move(out, &j->moves[i]);
+    }
+
+    struct iovec iov = {.iov_base = j->buffer, .iov_len = (size_t)(out - j->buffer)};
+
+    if (!j->failed && iov.iov_len > 0 && !write_all(j->fd, &iov, 1)) {
+        j->failed = true;
+        j->error = errno;
+    }
+
+    j->moves_count = 0;
+    j->length = 0;
+}
+
+// Adds the move and its result to the journal (or the other record, if
+// the result has also the kind of the record, see journal_event).
+static void journal_move(journal_t* j, uint32_t player, uint32_t x, uint32_t y,
+                         uint32_t result) {
+    j->moves[j->moves_count] = (journal_move_t){.player = player, .x = x, .y = y,
+                                                .result = result};
+    j->moves_count++;
+
+    if (j->moves_count == JOURNAL_BLOCK_MOVES) {
+        flush_journal(j);
+    }
+}
+
+// Adds the record of the given kind (for example JOURNAL_UNDO) and its result
+// to the journal.
+static void journal_event(journal_t* j, uint32_t kind, bool result) {
+    journal_move(j, 0, 0, 0, kind << 1 | (uint32_t)result);
+}
+
+bool game_journal_start(game_t* g, int fd) {
+    if (!g || g->journal) {
+        errno = EINVAL;
+
+        return false;
+    }
+
+    journal_t* j = malloc(sizeof(journal_t));
+
+    if (!j) {
+        errno = ENOMEM;
+
+        return false;
+    }
+
+    journal_header_t h;
+
+    memset(&h, 0, sizeof(journal_header_t));
+    memcpy(h.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    h.version = JOURNAL_VERSION;
+    h.byte_order = SAVE_BYTE_ORDER;
+    h.width = g->width;
+    h.height = g->height;
+    h.number_of_players = g->number_of_players;
+    h.max_areas = g->max_areas;
+
+    j->fd = fd;
+    j->failed = false;
+    j->error = 0;
+    j->moves_count = 0;
+    j->length = sizeof(journal_header_t);
+    memcpy(j->buffer, &h, sizeof(journal_header_t));
+    g->journal = j;
+
+    // The game replayed from the journal has to keep the history too.
+    if (g->history) {
+        journal_event(j, JOURNAL_HISTORY_ENABLE, true);
+    }
+
+    return true;
+}
+
+bool game_journal_stop(game_t* g) {
+    if (!g || !g->journal) {
+        errno = EINVAL;
+
+        return false;
+    }
+
+    journal_t* j = g->journal;
+
+    flush_journal(j);
+    g->journal = NULL;
+
+    bool success = !j->failed;
+
+    if (!success) {
+        errno = j->error;
+    }
+
+    free(j);
+
+    return success;
+}
+
+bool game_move(game_t* g, uint32_t player, uint32_t x, uint32_t y) {
+    if (!g) {
+        return false;
+    }
+
+    bool result = correct_move(g, player, x, y) && make_move(g, player, x, y);
+
+    COUNT(g, moves, 1);
+
+    if (g->journal) {
+        journal_move(g->journal, player, x, y, result);
+    }
+
+    return result;
+}
+
+// Prefetches the board fields read by the move, if its coordinate is
+// correct and the board is dense. Prefetching never faults, but the index
+// of a wrong coordinate could point outside of the board planes.
+static void prefetch_move(game_t const* g, game_move_t const* move) {
+    if (!g->tiles && move->x < g->width && move->y < g->height) {
+        uint64_t index = field_index(g, move->x, move->y);
+
+        __builtin_prefetch(&g->owners[index - 2 * g->stride]);
+        __builtin_prefetch(&g->owners[index - g->stride]);
+        __builtin_prefetch(&g->owners[index]);
+        __builtin_prefetch(&g->owners[index + g->stride]);
+        __builtin_prefetch(&g->owners[index + 2 * g->stride]);
+        __builtin_prefetch(&g->colors[index - g->stride]);
+        __builtin_prefetch(&g->colors[index]);
+        __builtin_prefetch(&g->colors[index + g->stride]);
+    }
+}
+
+uint64_t game_move_batch(game_t* g, game_move_t const* moves, uint64_t count,
+                         bool* results) {
+    uint64_t made_moves = 0;
+
+    if (!g) {
+        for (uint64_t i = 0; results && i < count; i++) {
+            results[i] = false;
+        }
+
+        return 0;
+    }
+
+    for (uint64_t i = 0; i < count; i++) {
+        if (i + MOVE_PREFETCH_DISTANCE < count) {
+            prefetch_move(g, &moves[i + MOVE_PREFETCH_DISTANCE]);
+        }
+
+        bool result = correct_move(g, moves[i].player, moves[i].x, moves[i].y) &&
+                      make_move(g, moves[i].player, moves[i].x, moves[i].y);
+
+        made_moves += result;
+        COUNT(g, moves, 1);
+
+        if (g->journal) {
+            journal_move(g->journal, moves[i].player, moves[i].x, moves[i].y, result);
+        }
+
+        if (results) {
+            results[i] = result;
+        }
+    }
+
+    return made_moves;
+}
+
+bool game_history_enable(game_t* g) {
+    if (!g) {
+        return false;
+    }
+
+    history_t* h = g->history;
+
+    if (!h) {
+        h = malloc(sizeof(history_t));
+
+        if (h) {
+            h->moves = malloc(INITIAL_HISTORY_CAPACITY * sizeof(history_move_t));
+            h->changes = malloc(INITIAL_HISTORY_CAPACITY * MAX_MOVE_CHANGES *
+                                sizeof(area_change_t));
+        }
+
+        if (!h || !h->moves || !h->changes) {
+            if (h) {
+                free(h->moves);
+                free(h->changes);
+                free(h);
+                h = NULL;
+            }
+
+            errno = ENOMEM;
+        }
+        else {
+            h->moves_count = 0;
+            h->moves_length = 0;
+            h->moves_capacity = INITIAL_HISTORY_CAPACITY;
+            h->changes_length = 0;
+            h->changes_capacity = INITIAL_HISTORY_CAPACITY * MAX_MOVE_CHANGES;
+            g->history = h;
+        }
+    }
+
+    if (g->journal) {
+        journal_event(g->journal, JOURNAL_HISTORY_ENABLE, h != NULL);
+    }
+
+    return h != NULL;
+}
+
+void game_history_disable(game_t* g) {
+    if (g && g->history) {
+        free(g->history->moves);
+        free(g->history->changes);
+        free(g->history);
+        g->history = NULL;
+
+        if (g->journal) {
+            journal_event(g->journal, JOURNAL_HISTORY_DISABLE, true);
+        }
+    }
+}
+
+// Takes back the last move kept in the history. Returns false if there is
+// no memory for the tile of its field (shared with a cloned game).
+static bool undo_move(game_t* g, history_t* h) {
+    history_move_t const* move = &h->moves[h->moves_count - 1];
+    uint32_t x = move->x;
+    uint32_t y = move->y;
+    tile_t* tile = NULL;
+
+    unshare_planes(g);
+
+    if (g->tiles && !(tile = get_tile(g, x, y))) {
+        return false;
+    }
+
+    // The changes of the forest are reverted from the last one, so every
+    // joined root is again directly under the root it was joined to.
+    uint64_t changes_begin = h->moves_count > 1 ? h->moves[h->moves_count - 2].changes_length
+                                                : 0;
+
+    while (h->changes_length > changes_begin) {
+        h->changes_length--;
+
+        area_change_t change = h->changes[h->changes_length];
+
+        if (change.parent == change.area) {
+            g->area_size[g->area_parent[change.area]] -= g->area_size[change.area];
+        }
+
+        g->area_parent[change.area] = change.parent;
+    }
+
+    // The area created by the move is the last one.
+    if (move->new_area) {
+        g->next_area--;
+    }
+
+    if (tile) {
+        tile->owners[tile_offset(x, y)] = 0;
+        tile->colors[tile_offset(x, y)] = 0;
+    }
+    else {
+        g->owners[field_index(g, x, y)] = 0;
+        g->colors[field_index(g, x, y)] = 0;
+    }
+
+    if (g->bitboards) {
+        clear_bitboard_field(g, move->player, x, y);
+    }
+
+    g->hash ^= zobrist_key(move->player, x, y);
+
+    // The frontier is not shrunk while the history is kept, so the fields
+    // added by the move are still at its end.
+    player_t* me = find_player(g, move->player);
+    uint32_t new_frontier = (uint32_t)__builtin_popcount(move->new_frontier);
+
+    me->busy_fields--;
+    me->busy_areas = move->busy_areas;
+    me->boundary_length -= new_frontier;
+    me->frontier_length -= new_frontier;
+    g->fields_to_take++;
+
+    // The field is free again for the players having figures next to it.
+    uint32_t neighbours[MAX_NEIGHBOURS];
+    int length = 0;
+
+    for (int i = 0; i < MAX_NEIGHBOURS; i++) {
+        uint32_t column = x + (uint32_t)NEIGHBOUR_DX[i];
+        uint32_t row = y + (uint32_t)NEIGHBOUR_DY[i];
+
+        if (column >= g->width || row >= g->height) {
+            continue;
+        }
+
+        uint32_t owner = field_player(g, column, row);
+        bool counted = owner == 0;
+
+        for (int j = 0; j < length; j++) {
+            counted |= neighbours[j] == owner;
+        }
+
+        if (!counted) {
+            neighbours[length] = owner;
+            length++;
+            find_player(g, owner)->boundary_length++;
+            update_blocked(g, owner);
+        }
+    }
+
+    update_blocked(g, move->player);
+    h->moves_count--;
+
+    return true;
+}
+
+bool game_undo(game_t* g) {
+    if (!g) {
+        return false;
+    }
+
+    history_t* h = g->history;
+    bool result = h && h->moves_count > 0 && undo_move(g, h);
+
+    if (g->journal) {
+        journal_event(g->journal, JOURNAL_UNDO, result);
+    }
+
+    return result;
+}
+
+bool game_redo(game_t* g) {
+    if (!g) {
+        return false;
+    }
+
+    history_t* h = g->history;
+    bool result = false;
+
+    if (h && h->moves_count < h->moves_length) {
+        history_move_t move = h->moves[h->moves_count];
+        uint64_t moves_length = h->moves_length;
+
+        // The game is the same as before the move, so the move is legal
+        // and it is made the same way.
+        result = make_move(g, move.player, move.x, move.y);
+
+        if (result) {
+            h->moves_length = moves_length;
+        }
+    }
+
+    if (g->journal) {
+        journal_event(g->journal, JOURNAL_REDO, result);
+    }
+
+    return result;
+}
+
+uint64_t game_hash(game_t const* g) {
+    return g ? g->hash : 0;
+}
+
+game_table_t* game_table_new(uint64_t entries) {
+    if (entries == 0 || entries > ((uint64_t)1 << 58)) {
+        return NULL;
+    }
+
+    game_table_t* t = malloc(sizeof(game_table_t));
+    uint64_t capacity = 1;
+
+    while (capacity < entries) {
+        capacity *= 2;
+    }
+
+    // The zeroed pages of a large table are given only when they are used.
+    if (t) {
+        t->mask = capacity - 1;
+        t->entries = allocate_plane(capacity * sizeof(table_entry_t));
+    }
+
+    if (!t || !t->entries) {
+        free(t);
+        errno = ENOMEM;
+
+        return NULL;
+    }
+
+    return t;
+}
+
+void game_table_delete(game_table_t* t) {
+    if (t) {
+        free_plane(t->entries, (t->mask + 1) * sizeof(table_entry_t));
+        free(t);
+    }
+}
+
+void game_table_store(game_table_t* t, uint64_t hash, uint64_t value) {
+    table_entry_t* entry = &t->entries[hash & t->mask];
+
+    atomic_store_explicit(&entry->check, hash ^ value ^ TABLE_CHECK, memory_order_relaxed);
+    atomic_store_explicit(&entry->value, value, memory_order_relaxed);
+}
+
+bool game_table_find(game_table_t const* t, uint64_t hash, uint64_t* value) {
+    table_entry_t* entry = &t->entries[hash & t->mask];
+    uint64_t check = atomic_load_explicit(&entry->check, memory_order_relaxed);
+    uint64_t found = atomic_load_explicit(&entry->value, memory_order_relaxed);
+
+    if ((check ^ found ^ TABLE_CHECK) != hash) {
+        return false;
+    }
+
+    *value = found;
+
+    return true;
+}
+
+bool game_stats(game_t const* g, game_stats_t* stats) {
+#ifdef GAME_STATS
+    if (!g || !stats) {
+        return false;
+    }
+
+    *stats = g->stats;
+
+    return true;
+#else
+    (void)g;
+    (void)stats;
+    errno = ENOTSUP;
+
+    return false;
+#endif
+}
+
+uint64_t game_busy_fields(game_t const* g, uint32_t player) {
+    if (!g || !correct_player_number(g, player)) {
+        return 0;
+    }
+
+    return read_player(g, player)->busy_fields;
+}
+
+uint64_t game_free_fields(game_t const* g, uint32_t player) {
+    if (!g || !correct_player_number(g, player)) {
+        return 0;
+    }
+    if (player_occupied_all_areas(g, player)) {
+        return read_player(g, player)->boundary_length;
+    }
+
+    return g->fields_to_take;
+}
+
+bool game_any_player_can_move(game_t const* g) {
+    // Only the blocked players cannot take any of the free fields.
+    return g && g->fields_to_take > 0 && g->blocked_players < g->number_of_players;
+}
+
+uint32_t game_next_player(game_t const* g, uint32_t player) {
+    if (!game_any_player_can_move(g)) {
+        return 0;
+    }
+
+    // The search starts after the player or, if he is wrong, from the first one.
+    uint32_t next = first_unblocked(g, player < g->number_of_players ? player : 0);
+
+    return next != 0 ? next : first_unblocked(g, 0);
+}
+
+void game_legal_moves_begin(game_t const* g, uint32_t player,
+                            game_legal_moves_iterator_t* it) {
+    it->g = g;
+    it->player = player;
+    it->position = 0;
+    it->whole_board = true;
+
+    if (!g || !correct_player_number(g, player)) {
+        // The iterator of a wrong player gives no fields.
+        it->position = UINT64_MAX;
+    }
+    else if (player_occupied_all_areas(g, player)) {
+        it->whole_board = false;
+    }
+}
+
+bool game_legal_moves_next(game_legal_moves_iterator_t* it, game_field_t* field) {
+    game_t const* g = it->g;
+
+    if (it->position == UINT64_MAX) {
+        return false;
+    }
+
+    // The player can only extend his areas, so only the not taken
+    // fields of his frontier are legal.
+    if (!it->whole_board) {
+        player_t const* p = read_player(g, it->player);
+
+        while (it->position < p->frontier_length) {
+            game_field_t candidate = p->frontier[it->position];
+
+            it->position++;
+
+            if (empty_field(g, candidate.x, candidate.y)) {
+                *field = candidate;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // The player can create a new area, so every empty field is legal.
+    // The position is the number of the field in the board read row by row.
+    uint32_t x = (uint32_t)(it->position % g->width);
+    uint32_t y = (uint32_t)(it->position / g->width);
+
+    for (; y < g->height; y++, x = 0) {
+        owner_t const* row = g->tiles ? NULL : &g->owners[field_index(g, 0, y)];
+
+        for (; x < g->width; x++) {
+            if (row ? row[x] == 0 : empty_field(g, x, y)) {
+                it->position = (uint64_t)y * g->width + x + 1;
+                field->x = x;
+                field->y = y;
+
+                return true;
+            }
+        }
+    }
+
+    it->position = UINT64_MAX;
+
+    return false;
+}
+
+uint64_t game_legal_moves(game_t const* g, uint32_t player, game_field_t* fields,
+                          uint64_t capacity) {
+    game_legal_moves_iterator_t it;
+    uint64_t length = 0;
+
+    game_legal_moves_begin(g, player, &it);
+
+    while (length < capacity && game_legal_moves_next(&it, &fields[length])) {
+        length++;
+    }
+
+    return game_free_fields(g, player);
+}
+
+bool game_bitboards_enable(game_t* g) {
+    if (!g) {
+        return false;
+    }
+    if (g->bitboards) {
+        return true;
+    }
+
+    // The bitboards of the sparse board would take as much memory as
+    // the dense board, which the sparse board is too big for.
+    if (g->tiles) {
+        errno = ENOMEM;
+
+        return false;
+    }
+
+    g->bitboard_stride = ((uint64_t)g->width + BITBOARD_WORD - 1) / BITBOARD_WORD + 1;
+    g->bitboard_length = g->bitboard_stride * ((uint64_t)g->height + 2);
+    g->bitboards = allocate_plane(bitboards_length(g));
+
+    if (!g->bitboards) {
+        return false;
+    }
+
+    for (uint32_t y = 0; y < g->height; y++) {
+        owner_t const* row = &g->owners[field_index(g, 0, y)];
+
+        for (uint32_t x = 0; x < g->width; x++) {
+            g->bitboards[bitboard_index(g, x, y)] |= (uint64_t)1 << (x % BITBOARD_WORD);
+
+            if (row[x] != 0) {
+                set_bitboard_field(g, field_player(g, x, y), x, y);
+            }
+        }
+    }
+
+    return true;
+}
+
+/** @brief Computes the frontier words of a player: out[i] has the bits of
+ * the empty fields of the word player[i] which have a neighbour taken by
+ * the player. The left and right neighbours are the bits shifted by one
+ * together with the carry from the words player[i - 1] and player[i + 1],
+ * the upper and lower ones are the words player[i -+ stride].
+ * @param[in] player  - pointer to the first word of the player plane,
+ * @param[in] empty   - pointer to the same word of the empty plane,
+ * @param[in] stride  - the number of words in one row,
+ * @param[in] length  - the number of computed words,
+ * @param[out] out    - the array of length words.
+ * @return The number of bits set in the out array.
+ */
+static uint64_t frontier_words_scalar(uint64_t const* player, uint64_t const* empty,
+                                      uint64_t stride, uint64_t length, uint64_t* out) {
+    uint64_t count = 0;
+
+    for (uint64_t i = 0; i < length; i++) {
+        uint64_t touched = (player[i] << 1 | player[i - 1] >> (BITBOARD_WORD - 1)) |
+                           (player[i] >> 1 | player[i + 1] << (BITBOARD_WORD - 1)) |
+                           player[i - stride] | player[i + stride];
+
+        out[i] = touched & empty[i];
+        count += (uint64_t)__builtin_popcountll(out[i]);
+    }
+
+    return count;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// The same as frontier_words_scalar, but computes four words at once
+// with AVX2 instructions. Used only if the processor supports them.
+__attribute__((target("avx2,popcnt")))
+static uint64_t frontier_words_avx2(uint64_t const* player, uint64_t const* empty,
+                                    uint64_t stride, uint64_t length, uint64_t* out) {
+    uint64_t count = 0;
+    uint64_t i = 0;
+
+    for (; i + 4 <= length; i += 4) {
+        __m256i current = _mm256_loadu_si256((__m256i const*)&player[i]);
+        __m256i previous = _mm256_loadu_si256((__m256i const*)&player[i - 1]);
+        __m256i next = _mm256_loadu_si256((__m256i const*)&player[i + 1]);
+        __m256i up = _mm256_loadu_si256((__m256i const*)&player[i - stride]);
+        __m256i down = _mm256_loadu_si256((__m256i const*)&player[i + stride]);
+        __m256i left = _mm256_or_si256(_mm256_slli_epi64(current, 1),
+                                       _mm256_srli_epi64(previous, BITBOARD_WORD - 1));
+        __m256i right = _mm256_or_si256(_mm256_srli_epi64(current, 1),
+                                        _mm256_slli_epi64(next, BITBOARD_WORD - 1));
+        __m256i touched = _mm256_or_si256(_mm256_or_si256(left, right),
+                                          _mm256_or_si256(up, down));
+        __m256i free = _mm256_and_si256(touched,
+                                        _mm256_loadu_si256((__m256i const*)&empty[i]));
+
+        _mm256_storeu_si256((__m256i*)&out[i], free);
+        count += (uint64_t)__builtin_popcountll(out[i]) +
+                 (uint64_t)__builtin_popcountll(out[i + 1]) +
+                 (uint64_t)__builtin_popcountll(out[i + 2]) +
+                 (uint64_t)__builtin_popcountll(out[i + 3]);
+    }
+
+    for (; i < length; i++) {
+        uint64_t touched = (player[i] << 1 | player[i - 1] >> (BITBOARD_WORD - 1)) |
+                           (player[i] >> 1 | player[i + 1] << (BITBOARD_WORD - 1)) |
+                           player[i - stride] | player[i + stride];
+
+        out[i] = touched & empty[i];
+        count += (uint64_t)__builtin_popcountll(out[i]);
+    }
+
+    return count;
+}
+
+#ifdef __SSE2__
+// The same as frontier_words_scalar, but computes two words at once
+// with SSE2 instructions, which every x86-64 processor has. On i386 they
+// are used only if the compiler is allowed to use them.
+static uint64_t frontier_words_sse2(uint64_t const* player, uint64_t const* empty,
+                                    uint64_t stride, uint64_t length, uint64_t* out) {
+    uint64_t count = 0;
+    uint64_t i = 0;
+
+    for (; i + 2 <= length; i += 2) {
+        __m128i current = _mm_loadu_si128((__m128i const*)&player[i]);
+        __m128i previous = _mm_loadu_si128((__m128i const*)&player[i - 1]);
+        __m128i next = _mm_loadu_si128((__m128i const*)&player[i + 1]);
+        __m128i up = _mm_loadu_si128((__m128i const*)&player[i - stride]);
+        __m128i down = _mm_loadu_si128((__m128i const*)&player[i + stride]);
+        __m128i left = _mm_or_si128(_mm_slli_epi64(current, 1),
+                                    _mm_srli_epi64(previous, BITBOARD_WORD - 1));
+        __m128i right = _mm_or_si128(_mm_srli_epi64(current, 1),
+                                     _mm_slli_epi64(next, BITBOARD_WORD - 1));
+        __m128i touched = _mm_or_si128(_mm_or_si128(left, right), _mm_or_si128(up, down));
+        __m128i free = _mm_and_si128(touched, _mm_loadu_si128((__m128i const*)&empty[i]));
+
+        _mm_storeu_si128((__m128i*)&out[i], free);
+        count += (uint64_t)__builtin_popcountll(out[i]) +
+                 (uint64_t)__builtin_popcountll(out[i + 1]);
+    }
+
+    return count + frontier_words_scalar(&player[i], &empty[i], stride, length - i, &out[i]);
+}
+#endif
+#endif
+
+// Computes length frontier words of the player starting from the word
+// with the given index (see frontier_words_scalar) with the fastest kernel
+// supported by the processor.
+static uint64_t frontier_words(game_t const* g, uint32_t player, uint64_t index,
+                               uint64_t length, uint64_t* out) {
+    uint64_t const* player_words = &g->bitboards[player * g->bitboard_length + index];
+    uint64_t const* empty_words = &g->bitboards[index];
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        return frontier_words_avx2(player_words, empty_words, g->bitboard_stride,
+                                   length, out);
+    }
+#endif
+
+#ifdef __SSE2__
+    return frontier_words_sse2(player_words, empty_words, g->bitboard_stride,
+                               length, out);
+#else
+    return frontier_words_scalar(player_words, empty_words, g->bitboard_stride,
+                                 length, out);
+#endif
+}
+
+uint64_t game_frontier(game_t const* g, uint32_t player, game_field_t* fields,
+                       uint64_t capacity) {
+    uint64_t length = 0;
+
+    if (!g || !correct_player_number(g, player)) {
+        return 0;
+    }
+
+    // Without the bitboards the frontier array of the player is filtered.
+    if (!g->bitboards) {
+        player_t const* p = read_player(g, player);
+
+        for (uint64_t i = 0; i < p->frontier_length && length < capacity; i++) {
+            if (empty_field(g, p->frontier[i].x, p->frontier[i].y)) {
+                fields[length] = p->frontier[i];
+                length++;
+            }
+        }
+
+        return p->boundary_length;
+    }
+
+    uint64_t words[FRONTIER_CHUNK_WORDS];
+    uint64_t end = ((uint64_t)g->height + 1) * g->bitboard_stride;
+    uint64_t count = 0;
+
+    for (uint64_t begin = g->bitboard_stride; begin < end; begin += FRONTIER_CHUNK_WORDS) {
+        uint64_t chunk = end - begin < FRONTIER_CHUNK_WORDS ? end - begin
+                                                            : FRONTIER_CHUNK_WORDS;
+
+        count += frontier_words(g, player, begin, chunk, words);
+
+        // The fields are read from the words only while they fit in the array.
+        for (uint64_t i = 0; i < chunk && length < capacity; i++) {
+            uint64_t y = (begin + i) / g->bitboard_stride - 1;
+            uint64_t x = (begin + i) % g->bitboard_stride * BITBOARD_WORD;
+
+            for (uint64_t word = words[i]; word != 0 && length < capacity; word &= word - 1) {
+                fields[length].x = (uint32_t)(x + (uint64_t)__builtin_ctzll(word));
+                fields[length].y = (uint32_t)y;
+                length++;
+            }
+        }
+    }
+
+    return count;
+}
+
+uint64_t game_general_free_fields(game_t const* g) {
+    return g->fields_to_take;
+}
+
+uint32_t game_board_width(game_t const *g) {
+    if (!g) {
+        return 0;
+    }
+
+    return g->width;
+}
+
+uint32_t game_board_height(game_t const *g) {
+    if (!g) {
+        return 0;
+    }
+
+    return g->height;
+}
+
+uint32_t game_areas(game_t const* g) {
+    return g->max_areas;
+}
+
+uint32_t game_players(game_t const *g) {
+    if (!g) {
+        return 0;
+    }
+
+    return g->number_of_players;
+}
+
+char game_player(game_t const* g, uint32_t player) {
+    if (!g || !correct_player_number(g, player) || g->symbol_width != 0) {
+        return '.';
+    }
+
+    return player_symbol(player);
+}
+
+// Writes the symbols of length owners to the row of the board.
+static void translate_row_scalar(char const* symbols, owner_t const* owners,
+                                 uint64_t length, char* row) {
+    for (uint64_t i = 0; i < length; i++) {
+        row[i] = symbols[owners[i]];
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// The same as translate_row_scalar, but translates 32 owners at once
+// with AVX2 instructions. The lower half of an owner selects the symbol
+// in every part of 16 symbols and the upper half selects the part.
+// Used only if the processor supports them.
+__attribute__((target("avx2")))
+static void translate_row_avx2(char const* symbols, owner_t const* owners,
+                               uint64_t length, char* row) {
+    __m256i parts[SYMBOLS_LENGTH / 16];
+    __m256i low_half = _mm256_set1_epi8(0x0F);
+    uint64_t i = 0;
+
+    for (int k = 0; k < SYMBOLS_LENGTH / 16; k++) {
+        parts[k] = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((__m128i const*)&symbols[16 * k]));
+    }
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i owner = _mm256_loadu_si256((__m256i const*)&owners[i]);
+        __m256i low = _mm256_and_si256(owner, low_half);
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(owner, 4), low_half);
+        __m256i symbol = _mm256_setzero_si256();
+
+        for (int k = 0; k < SYMBOLS_LENGTH / 16; k++) {
+            __m256i in_part = _mm256_cmpeq_epi8(high, _mm256_set1_epi8((char)k));
+
+            symbol = _mm256_or_si256(symbol, _mm256_and_si256(
+                    in_part, _mm256_shuffle_epi8(parts[k], low)));
+        }
+
+        _mm256_storeu_si256((__m256i*)&row[i], symbol);
+    }
+
+    translate_row_scalar(symbols, &owners[i], length - i, &row[i]);
+}
+#endif
+
+// Writes the symbols of length owners to the row of the board with
+// the fastest function supported by the processor.
+static void translate_row(game_t const* g, owner_t const* owners, uint64_t length,
+                          char* row) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        translate_row_avx2(g->symbols, owners, length, row);
+
+        return;
+    }
+#endif
+
+    translate_row_scalar(g->symbols, owners, length, row);
+}
+
+// Writes the symbols of length fields of the row y starting from the column x.
+// The rows of the sparse board are read tile by tile and the fields of
+// the missing tiles are read from the shared planes or they are empty.
+static void render_row(game_t const* g, uint32_t y, uint32_t x, uint64_t length,
+                       char* buffer) {
+    if (!g->tiles) {
+        translate_row(g, &g->owners[field_index(g, x, y)], length, buffer);
+
+        return;
+    }
+
+    while (length > 0) {
+        uint64_t part = TILE_SIDE - x % TILE_SIDE < length ? TILE_SIDE - x % TILE_SIDE
+                                                             : length;
+        tile_t const* tile = find_tile(g, x, y);
+
+        if (tile) {
+            translate_row(g, &tile->owners[tile_offset(x, y)], part, buffer);
+        }
+        else if (g->shared_planes) {
+            translate_row(g, &g->shared_planes->owners[field_index(g, x, y)], part, buffer);
+        }
+        else {
+            memset(buffer, '.', part);
+        }
+
+        buffer += part;
+        length -= part;
+        x += (uint32_t)part;
+    }
+}
+
+// Returns the length of the board text without the terminating '\0'.
+static uint64_t board_text_length(game_t const* g) {
+    if (g->symbol_width != 0) {
+        return ((uint64_t)g->symbol_width + 1) * g->width * g->height;
+    }
+
+    return ((uint64_t)g->width + 1) * (uint64_t)g->height;
+}
+
+// The same as render_board_part in the games whose players are written
+// as numbers. Every field takes symbol_width + 1 characters: the player
+// number (or '.' if the field is empty) aligned to the right and a space
+// or, after the last field of the row, a new line.
+static void render_numbers_part(game_t const* g, uint64_t offset, uint64_t length,
+                                char* buffer) {
+    uint64_t field_length = (uint64_t)g->symbol_width + 1;
+    uint64_t field = offset / field_length;
+    uint64_t skipped = offset % field_length;
+    char text[16];
+
+    while (length > 0) {
+        uint32_t x = (uint32_t)(field % g->width);
+        uint32_t y = (uint32_t)(g->height - 1 - field / g->width);
+        uint32_t player = field_player(g, x, y);
+        uint64_t position = field_length - 1;
+
+        memset(text, ' ', field_length);
+        text[position] = x + 1 == g->width ? '\n' : ' ';
+
+        if (player == 0) {
+            text[position - 1] = '.';
+        }
+
+        for (; player > 0; player /= 10) {
+            position--;
+            text[position] = (char)('0' + player % 10);
+        }
+
+        uint64_t part = field_length - skipped < length ? field_length - skipped : length;
+
+        memcpy(buffer, &text[skipped], part);
+        buffer += part;
+        length -= part;
+        skipped = 0;
+        field++;
+    }
+}
+
+// Writes length characters of the board text starting from the given
+// offset to the buffer. The text is the same as the one of game_board.
+static void render_board_part(game_t const* g, uint64_t offset, uint64_t length,
+                              char* buffer) {
+    if (g->symbol_width != 0) {
+        render_numbers_part(g, offset, length, buffer);
+
+        return;
+    }
+
+    uint64_t row_length = (uint64_t)g->width + 1;
+    uint64_t row = offset / row_length;
+    uint64_t column = offset % row_length;
+
+    while (length > 0) {
+        // The rows of the text are the rows of the board from the last one.
+        if (column < g->width) {
+            uint32_t y = (uint32_t)(g->height - 1 - row);
+            uint64_t part = g->width - column < length ? g->width - column : length;
+
+            render_row(g, y, (uint32_t)column, part, buffer);
+            buffer += part;
+            length -= part;
+            column += part;
+        }
+
+        if (length > 0) {
+            *buffer = '\n';
+            buffer++;
+            length--;
+            column = 0;
+            row++;
+        }
+    }
+}
+
+uint64_t game_board_into(game_t const* g, char* buffer, uint64_t length) {
+    if (!g) {
+        return 0;
+    }
+
+    uint64_t size = board_text_length(g) + 1;
+
+    if (length < size) {
+        return size;
+    }
+
+    render_board_part(g, 0, size - 1, buffer);
+    buffer[size - 1] = '\0';
+
+    return size;
+}
+
+char* game_board(game_t const *g) {
+    if (!g) {
+        return NULL;
+    }
+
+    uint64_t size = game_board_into(g, NULL, 0);
+    char* board = (char*)malloc(size * sizeof(char));
+
+    if (!board) {
+        return NULL;
+    }
+
+    game_board_into(g, board, size);
+
+    return board;
+}
+
+/** @brief The state of the board text written by game_board_write.
+ * The text is split in chunks of BOARD_CHUNK_LENGTH characters. The chunk c
+ * is rendered by some thread to the slot c % BOARD_WRITER_SLOTS and written
+ * by the calling thread, when all chunks before it are written.
+ * g              - pointer to the game structure,
+ * fd             - the written file descriptor,
+ * length         - the length of the board text,
+ * chunks         - the number of chunks,
+ * next_chunk     - the number of the next chunk to render,
+ * written_chunks - the number of the already written chunks,
+ * rendered       - rendered[i] is true if the slot i keeps a rendered chunk,
+ * slots          - the buffers of all slots,
+ * failed         - true if writing failed and the threads have to stop,
+ * lock           - protects all the fields above except g, fd, length, chunks,
+ * chunk_rendered - signalled when a chunk is rendered,
+ * chunk_written  - signalled when a chunk is written or writing failed.
+ */
+typedef struct Board_writer {
+    game_t const* g;
+    int fd;
+    uint64_t length;
+    uint64_t chunks;
+    uint64_t next_chunk;
+    uint64_t written_chunks;
+    bool rendered[BOARD_WRITER_SLOTS];
+    char* slots;
+    bool failed;
+    pthread_mutex_t lock;
+    pthread_cond_t chunk_rendered;
+    pthread_cond_t chunk_written;
+} board_writer_t;
+
+// Returns the length of the chunk of the board text.
+static uint64_t chunk_length(board_writer_t const* w, uint64_t chunk) {
+    uint64_t offset = chunk * BOARD_CHUNK_LENGTH;
+
+    return w->length - offset < BOARD_CHUNK_LENGTH ? w->length - offset
+                                                   : BOARD_CHUNK_LENGTH;
+}
+
+// Renders the chunks of the board text while there are any left. A thread
+// waits for its slot to be written before it renders the next chunk.
+static void* render_chunks(void* data) {
+    board_writer_t* w = data;
+
+    pthread_mutex_lock(&w->lock);
+
+    while (true) {
+        while (!w->failed && w->next_chunk < w->chunks &&
+               w->next_chunk >= w->written_chunks + BOARD_WRITER_SLOTS) {
+            pthread_cond_wait(&w->chunk_written, &w->lock);
+        }
+
+        if (w->failed || w->next_chunk >= w->chunks) {
+            break;
+        }
+
+        uint64_t chunk = w->next_chunk;
+        w->next_chunk++;
+        pthread_mutex_unlock(&w->lock);
+
+        render_board_part(w->g, chunk * BOARD_CHUNK_LENGTH, chunk_length(w, chunk),
+                          &w->slots[chunk % BOARD_WRITER_SLOTS * BOARD_CHUNK_LENGTH]);
+
+        pthread_mutex_lock(&w->lock);
+        w->rendered[chunk % BOARD_WRITER_SLOTS] = true;
+        pthread_cond_signal(&w->chunk_rendered);
+    }
+
+    pthread_mutex_unlock(&w->lock);
+
+    return NULL;
+}
+
+// Writes the rendered chunks in their order. Every call of writev writes all
+// chunks rendered one after another since the last written one.
+static bool write_chunks(board_writer_t* w) {
+    struct iovec iov[BOARD_WRITER_SLOTS];
+
+    while (w->written_chunks < w->chunks) {
+        int ready = 0;
+
+        pthread_mutex_lock(&w->lock);
+
+        while (!w->rendered[w->written_chunks % BOARD_WRITER_SLOTS]) {
+            pthread_cond_wait(&w->chunk_rendered, &w->lock);
+        }
+
+        while (ready < BOARD_WRITER_SLOTS && w->written_chunks + ready < w->chunks &&
+               w->rendered[(w->written_chunks + ready) % BOARD_WRITER_SLOTS]) {
+            uint64_t chunk = w->written_chunks + ready;
+
+            iov[ready].iov_base = &w->slots[chunk % BOARD_WRITER_SLOTS * BOARD_CHUNK_LENGTH];
+            iov[ready].iov_len = chunk_length(w, chunk);
+            ready++;
+        }
+
+        pthread_mutex_unlock(&w->lock);
+
+        bool success = write_all(w->fd, iov, ready);
+
+        pthread_mutex_lock(&w->lock);
+
+        for (int i = 0; i < ready; i++) {
+            w->rendered[(w->written_chunks + i) % BOARD_WRITER_SLOTS] = false;
+        }
+
+        w->written_chunks += ready;
+        w->failed = !success;
+        pthread_cond_broadcast(&w->chunk_written);
+        pthread_mutex_unlock(&w->lock);
+
+        if (!success) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Renders and writes the chunks one by one in the calling thread using
+// only the first slot. Used if no rendering thread could be created.
+static bool write_chunks_sequentially(board_writer_t* w) {
+    for (uint64_t chunk = 0; chunk < w->chunks; chunk++) {
+        struct iovec iov = {.iov_base = w->slots, .iov_len = chunk_length(w, chunk)};
+
+        render_board_part(w->g, chunk * BOARD_CHUNK_LENGTH, iov.iov_len, w->slots);
+
+        if (!write_all(w->fd, &iov, 1)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Returns the number of threads rendering the chunks.
+static uint64_t writer_threads(uint64_t chunks) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t threads = processors > 0 ? (uint64_t)processors : 1;
+
+    threads = threads < BOARD_WRITER_THREADS ? threads : BOARD_WRITER_THREADS;
+
+    return threads < chunks ? threads : chunks;
+}
+
+bool game_board_write(game_t const* g, int fd) {
+    if (!g) {
+        errno = EINVAL;
+
+        return false;
+    }
+
+    board_writer_t w = {.g = g, .fd = fd, .length = board_text_length(g)};
+    uint64_t slots = BOARD_WRITER_SLOTS;
+
+    w.chunks = (w.length + BOARD_CHUNK_LENGTH - 1) / BOARD_CHUNK_LENGTH;
+    slots = w.chunks < slots ? w.chunks : slots;
+    w.slots = malloc(slots * BOARD_CHUNK_LENGTH);
+
+    if (!w.slots) {
+        return false;
+    }
+
+    pthread_mutex_init(&w.lock, NULL);
+    pthread_cond_init(&w.chunk_rendered, NULL);
+    pthread_cond_init(&w.chunk_written, NULL);
+
+    pthread_t threads[BOARD_WRITER_THREADS];
+    uint64_t created = 0;
+    uint64_t wanted = writer_threads(w.chunks);
+
+    while (created < wanted && pthread_create(&threads[created], NULL,
+                                              render_chunks, &w) == 0) {
+        created++;
+    }
+
+    bool success = created > 0 ? write_chunks(&w) : write_chunks_sequentially(&w);
+    int error = errno;
+
+    for (uint64_t i = 0; i < created; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&w.chunk_written);
+    pthread_cond_destroy(&w.chunk_rendered);
+    pthread_mutex_destroy(&w.lock);
+    free(w.slots);
+    errno = error;
+
+    return success;
+}
+
+/** @brief The header of the files written by game_save. The file contains
+ * in turn: the header, the players table (saved_players save_player_t records
+ * of the players who moved, from players_offset), the area_parent, area_size
+ * and, if the game keeps it, area_owner arrays (next_area numbers each from
+ * areas_offset), the frontier arrays of the saved players (from
+ * frontier_offset) and the board from board_offset. The dense board is kept as
+ * the owners plane at board_offset and the colors plane at colors_offset, both
+ * aligned to SAVE_ALIGNMENT. The sparse board is kept as tiles_count records of
+ * the key and the tile. All numbers are kept in the byte order of the machine.
+ */
+typedef struct Save_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t width;
+    uint32_t height;
+    uint32_t number_of_players;
+    uint32_t max_areas;
+    uint64_t fields_to_take;
+    uint64_t next_area;
+    uint64_t hash;
+    uint64_t sparse;
+    uint64_t tiles_count;
+    uint64_t saved_players;
+    uint64_t players_offset;
+    uint64_t areas_offset;
+    uint64_t frontier_offset;
+    uint64_t board_offset;
+    uint64_t colors_offset;
+    uint64_t length;
+} save_header_t;
+
+/** @brief A record of the players table in the files written by game_save.
+ * The player is the player number and the other fields are the same as
+ * in player_t. The records are kept in the order of the players.
+ */
+typedef struct Save_player {
+    uint64_t player;
+    uint64_t busy_fields;
+    uint64_t boundary_length;
+    uint64_t frontier_length;
+    uint64_t busy_areas;
+} save_player_t;
+
+// Returns the offset rounded up to the multiple of the alignment.
+static uint64_t align_offset(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Writes length bytes of the data to the file descriptor and adds length
+// to the offset. Returns false if writing failed.
+static bool write_section(int fd, void const* data, uint64_t length, uint64_t* offset) {
+    struct iovec iov = {.iov_base = (void*)data, .iov_len = length};
+
+    *offset += length;
+
+    return length == 0 || write_all(fd, &iov, 1);
+}
+
+// Writes zeros to the file descriptor until the offset is the multiple
+// of the alignment. Returns false if writing failed.
+static bool write_padding(int fd, uint64_t alignment, uint64_t* offset) {
+    static char const zeros[SAVE_ALIGNMENT];
+
+    return write_section(fd, zeros, align_offset(*offset, alignment) - *offset, offset);
+}
+
+// Returns true if the player is saved by game_save, i.e. he is not
+// the same as the player who has not moved yet.
+static bool saved_player(player_t const* p) {
+    return p->busy_fields != 0 || p->boundary_length != 0 || p->frontier_length != 0 ||
+           p->busy_areas != 0;
+}
+
+// Returns the number of the arrays of the areas kept by the game.
+static uint64_t area_arrays(uint32_t players) {
+    return players > MAX_OWNER_TAG ? 3 : 2;
+}
+
+// Fills the header of the file written by game_save.
+static void fill_save_header(game_t const* g, save_header_t* h) {
+    uint64_t frontier_length = 0;
+    uint64_t players = 0;
+
+    for (uint64_t page = 0; page < player_pages_count(g); page++) {
+        player_t const* p = g->player_pages[page] ? g->player_pages[page]->players : NULL;
+
+        for (uint64_t i = 0; p && i < page_players(g, page); i++) {
+            if (saved_player(&p[i])) {
+                players++;
+                frontier_length += p[i].frontier_length;
+            }
+        }
+    }
+
+    memset(h, 0, sizeof(save_header_t));
+    memcpy(h->magic, SAVE_MAGIC, sizeof(SAVE_MAGIC));
+    h->version = SAVE_VERSION;
+    h->byte_order = SAVE_BYTE_ORDER;
+    h->width = g->width;
+    h->height = g->height;
+    h->number_of_players = g->number_of_players;
+    h->max_areas = g->max_areas;
+    h->fields_to_take = g->fields_to_take;
+    h->next_area = g->next_area;
+    h->hash = g->hash;
+    h->sparse = g->tiles && !g->shared_planes;
+    h->tiles_count = h->sparse ? g->tiles_count : 0;
+    h->saved_players = players;
+    h->players_offset = sizeof(save_header_t);
+    h->areas_offset = h->players_offset + players * sizeof(save_player_t);
+    h->frontier_offset = align_offset(h->areas_offset + area_arrays(g->number_of_players) *
+                                      g->next_area * sizeof(area_t), sizeof(uint64_t));
+    h->board_offset = align_offset(h->frontier_offset +
+                                   frontier_length * sizeof(game_field_t), SAVE_ALIGNMENT);
+
+    if (h->sparse) {
+        h->length = h->board_offset + g->tiles_count * (sizeof(uint64_t) + TILE_DATA_LENGTH);
+    }
+    else {
+        h->colors_offset = align_offset(h->board_offset + plane_length(g) * sizeof(owner_t),
+                                        SAVE_ALIGNMENT);
+        h->length = h->colors_offset + plane_length(g) * sizeof(area_t);
+    }
+}
+
+// Writes the plane of the board sharing the planes with other games: the
+// shared plane with the fields of the tiles of the game put over it. If colors
+// is true, writes the colors plane and otherwise the owners plane. Returns false
+// if writing failed or there is no memory.
+static bool write_shared_plane(game_t const* g, int fd, bool colors, uint64_t* offset) {
+    uint64_t field_length = colors ? sizeof(area_t) : sizeof(owner_t);
+    uint64_t row_length = g->stride * field_length;
+    char const* plane = colors ? (char const*)g->shared_planes->colors
+                               : (char const*)g->shared_planes->owners;
+    char* row = malloc(row_length);
+    bool success = row != NULL;
+
+    for (uint64_t y = 0; success && y < (uint64_t)g->height + 2 * BORDER; y++) {
+        uint32_t board_y = (uint32_t)(y - BORDER);
+        bool board_row = y >= BORDER && board_y < g->height;
+
+        memcpy(row, &plane[y * row_length], row_length);
+
+        for (uint32_t x = 0; board_row && x < g->width; x += TILE_SIDE) {
+            tile_t const* tile = find_tile(g, x, board_y);
+            uint64_t columns = g->width - x < TILE_SIDE ? g->width - x : TILE_SIDE;
+
+            if (tile) {
+                char const* fields = colors ? (char const*)tile->colors
+                                            : (char const*)tile->owners;
+
+                memcpy(&row[x * field_length],
+                       &fields[tile_offset(x, board_y) * field_length],
+                       columns * field_length);
+            }
+        }
+
+        success = write_section(fd, row, row_length, offset);
+    }
+
+    if (!row) {
+        errno = ENOMEM;
+    }
+
+    free(row);
+
+    return success;
+}
+
+bool game_save(game_t const* g, int fd) {
+    if (!g) {
+        errno = EINVAL;
+
+        return false;
+    }
+
+    save_header_t h;
+    uint64_t offset = 0;
+    bool success;
+
+    fill_save_header(g, &h);
+    success = write_section(fd, &h, sizeof(save_header_t), &offset);
+
+    for (uint64_t page = 0; success && page < player_pages_count(g); page++) {
+        player_t const* p = g->player_pages[page] ? g->player_pages[page]->players : NULL;
+
+        for (uint64_t i = 0; success && p && i < page_players(g, page); i++) {
+            save_player_t record = {.player = (page << PLAYERS_PAGE_BITS) + i + 1,
+                                    .busy_fields = p[i].busy_fields,
+                                    .boundary_length = p[i].boundary_length,
+                                    .frontier_length = p[i].frontier_length,
+                                    .busy_areas = p[i].busy_areas};
+
+            if (saved_player(&p[i])) {
+                success = write_section(fd, &record, sizeof(save_player_t), &offset);
+            }
+        }
+    }
+
+    success = success &&
+              write_section(fd, g->area_parent, g->next_area * sizeof(area_t), &offset) &&
+              write_section(fd, g->area_size, g->next_area * sizeof(area_t), &offset) &&
+              (!g->area_owner ||
+               write_section(fd, g->area_owner, g->next_area * sizeof(uint32_t), &offset)) &&
+              write_padding(fd, sizeof(uint64_t), &offset);
+
+    for (uint64_t page = 0; success && page < player_pages_count(g); page++) {
+        player_t const* p = g->player_pages[page] ? g->player_pages[page]->players : NULL;
+
+        for (uint64_t i = 0; success && p && i < page_players(g, page); i++) {
+            success = write_section(fd, p[i].frontier,
+                                    p[i].frontier_length * sizeof(game_field_t), &offset);
+        }
+    }
+
+    success = success && write_padding(fd, SAVE_ALIGNMENT, &offset);
+
+    // The board sharing the planes is written as the dense one.
+    if (g->shared_planes) {
+        return success && write_shared_plane(g, fd, false, &offset) &&
+               write_padding(fd, SAVE_ALIGNMENT, &offset) &&
+               write_shared_plane(g, fd, true, &offset);
+    }
+
+    if (!g->tiles) {
+        return success &&
+               write_section(fd, g->owners, plane_length(g) * sizeof(owner_t), &offset) &&
+               write_padding(fd, SAVE_ALIGNMENT, &offset) &&
+               write_section(fd, g->colors, plane_length(g) * sizeof(area_t), &offset);
+    }
+
+    for (uint64_t i = 0; success && i < g->tiles_capacity; i++) {
+        if (g->tiles[i].tile) {
+            success = write_section(fd, &g->tiles[i].key, sizeof(uint64_t), &offset) &&
+                      write_section(fd, g->tiles[i].tile, TILE_DATA_LENGTH, &offset);
+        }
+    }
+
+    return success;
+}
+
+// Returns true if the header describes a correct game and all its parts fit
+// in the file of the given length and false otherwise.
+static bool correct_save_header(save_header_t const* h, uint64_t length) {
+    uint64_t fields = (uint64_t)h->width * h->height;
+    uint64_t stride = (uint64_t)h->width + BORDER;
+    uint64_t plane = stride * ((uint64_t)h->height + 2 * BORDER);
+
+    if (memcmp(h->magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0 ||
+        h->version != SAVE_VERSION || h->byte_order != SAVE_BYTE_ORDER ||
+        h->length != length || h->width == 0 || h->height == 0 ||
+        h->number_of_players == 0 || h->saved_players > h->number_of_players ||
+        h->max_areas == 0 || h->fields_to_take > fields || h->next_area == 0 ||
+        h->next_area > MAX_AREAS_CAPACITY || h->sparse > 1) {
+        return false;
+    }
+
+    if (h->players_offset != sizeof(save_header_t) ||
+        h->areas_offset != h->players_offset + h->saved_players * sizeof(save_player_t) ||
+        h->frontier_offset < h->areas_offset + area_arrays(h->number_of_players) *
+                                               h->next_area * sizeof(area_t) ||
+        h->frontier_offset % sizeof(uint64_t) != 0 || h->board_offset < h->frontier_offset ||
+        h->board_offset % SAVE_ALIGNMENT != 0 || h->board_offset > length) {
+        return false;
+    }
+
+    if (h->sparse) {
+        return h->tiles_count <= (length - h->board_offset) /
+                                 (sizeof(uint64_t) + TILE_DATA_LENGTH) &&
+               h->board_offset + h->tiles_count * (sizeof(uint64_t) + TILE_DATA_LENGTH) == length;
+    }
+
+    return fields <= MAX_DENSE_FIELDS && h->colors_offset % SAVE_ALIGNMENT == 0 &&
+           h->colors_offset >= h->board_offset + plane * sizeof(owner_t) &&
+           h->colors_offset + plane * sizeof(area_t) == length;
+}
+
+// Returns true if the owner and the color describe a correct field
+// of the loaded game: an empty field has no color and a taken field has
+// the owner tag of one of the players and the number of one of the areas.
+static bool correct_field(game_t const* g, owner_t owner, area_t color) {
+    if (owner == 0) {
+        return color == 0;
+    }
+
+    return (g->number_of_players > MAX_OWNER_TAG || owner <= g->number_of_players) &&
+           color != 0 && color < g->next_area;
+}
+
+// Returns true if the planes of the dense board kept in the file describe
+// correct fields and their border is empty, and false otherwise.
+static bool correct_planes(game_t const* g, owner_t const* owners, area_t const* colors) {
+    for (uint64_t row = 0; row < (uint64_t)g->height + 2 * BORDER; row++) {
+        bool border = row < BORDER || row >= (uint64_t)g->height + BORDER;
+        uint64_t first = row * g->stride;
+
+        for (uint64_t column = 0; column < g->stride; column++) {
+            owner_t owner = owners[first + column];
+            area_t color = colors[first + column];
+            bool correct = border || column >= g->width ? owner == 0 && color == 0
+                                                        : correct_field(g, owner, color);
+
+            if (!correct) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Returns true if the tile at the coordinate (x,y) describes correct fields
+// and its fields outside of the board are empty, and false otherwise.
+static bool correct_tile(game_t const* g, tile_t const* tile, uint64_t x, uint64_t y) {
+    for (uint64_t row = 0; row < TILE_SIDE; row++) {
+        for (uint64_t column = 0; column < TILE_SIDE; column++) {
+            owner_t owner = tile->owners[row * TILE_SIDE + column];
+            area_t color = tile->colors[row * TILE_SIDE + column];
+            bool outside = x + column >= g->width || y + row >= g->height;
+            bool correct = outside ? owner == 0 && color == 0 : correct_field(g, owner, color);
+
+            if (!correct) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Returns the root of the tree of the color without compressing the path.
+// The depth of the forest has to be already checked (see correct_forest).
+static area_t area_root(game_t const* g, area_t color) {
+    while (g->area_parent[color] != color) {
+        color = g->area_parent[color];
+    }
+
+    return color;
+}
+
+// Returns true if the area_parent array of the loaded game is a forest which
+// union by size could build and false otherwise or if there is no memory for
+// the check: every tree is at most MAX_AREA_DEPTH deep (so there is no cycle),
+// area_size of its root is the number of its colors and a color at depth d
+// has a tree of at least 2^d colors.
+static bool correct_forest(game_t const* g) {
+    area_t* sizes = calloc(g->next_area, sizeof(area_t));
+    bool success = sizes != NULL;
+
+    for (uint64_t i = 1; success && i < g->next_area; i++) {
+        area_t root = (area_t)i;
+        uint32_t depth = 0;
+
+        while (g->area_parent[root] != root && depth <= MAX_AREA_DEPTH) {
+            root = g->area_parent[root];
+            depth++;
+        }
+
+        success = depth <= MAX_AREA_DEPTH;
+        sizes[root]++;
+    }
+
+    for (uint64_t i = 1; success && i < g->next_area; i++) {
+        area_t root = (area_t)i;
+        uint32_t depth = 0;
+
+        while (g->area_parent[root] != root) {
+            root = g->area_parent[root];
+            depth++;
+        }
+
+        success = g->area_size[root] == sizes[root] && ((uint64_t)1 << depth) <= sizes[root];
+    }
+
+    free(sizes);
+
+    return success;
+}
+
+// Copies the players and the areas from the mapped file to the new game.
+// The frontiers are used in place in the file (see frontier_mapped), so
+// the file has to stay mapped as long as the game exists. Returns false
+// if they are not correct (including the fields of the frontiers outside
+// of the board and the cycles of the areas) or there is no memory for them.
+static bool load_players(game_t* g, char* file, save_header_t const* h) {
+    save_player_t const* records = (save_player_t const*)&file[h->players_offset];
+    game_field_t* frontier = (game_field_t*)&file[h->frontier_offset];
+    uint64_t capacity = h->next_area < INITIAL_AREAS_CAPACITY ? INITIAL_AREAS_CAPACITY
+                                                               : h->next_area;
+    area_t* area_parent = realloc(g->area_parent, capacity * sizeof(area_t));
+
+    if (area_parent) {
+        g->area_parent = area_parent;
+    }
+
+    area_t* area_size = realloc(g->area_size, capacity * sizeof(area_t));
+
+    if (area_size) {
+        g->area_size = area_size;
+    }
+
+    uint32_t* area_owner = g->area_owner ? realloc(g->area_owner, capacity * sizeof(uint32_t))
+                                         : NULL;
+
+    if (area_owner) {
+        g->area_owner = area_owner;
+    }
+
+    if (!area_parent || !area_size || (g->area_owner && !area_owner)) {
+        return false;
+    }
+
+    g->areas_capacity = capacity;
+    g->next_area = h->next_area;
+    g->fields_to_take = h->fields_to_take;
+    g->hash = h->hash;
+    memcpy(g->area_parent, &file[h->areas_offset], h->next_area * sizeof(area_t));
+    memcpy(g->area_size, &file[h->areas_offset + h->next_area * sizeof(area_t)],
+           h->next_area * sizeof(area_t));
+
+    if (g->area_owner) {
+        memcpy(g->area_owner, &file[h->areas_offset + 2 * h->next_area * sizeof(area_t)],
+               h->next_area * sizeof(uint32_t));
+    }
+
+    for (uint64_t i = 1; i < g->next_area; i++) {
+        if (g->area_parent[i] == 0 || g->area_parent[i] >= g->next_area ||
+            (g->area_owner && (g->area_owner[i] == 0 ||
+                               g->area_owner[i] > g->number_of_players))) {
+            return false;
+        }
+    }
+
+    if (!correct_forest(g)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < h->saved_players; i++) {
+        uint64_t length = records[i].frontier_length;
+
+        // The players are saved in their order, so every one is loaded once.
+        if (records[i].player == 0 || records[i].player > g->number_of_players ||
+            (i > 0 && records[i].player <= records[i - 1].player) ||
+            records[i].busy_areas > g->max_areas ||
+            length > (h->board_offset - ((char const*)frontier - file)) / sizeof(game_field_t)) {
+            return false;
+        }
+
+        for (uint64_t j = 0; j < length; j++) {
+            if (!correct_coordinate(g, frontier[j].x, frontier[j].y)) {
+                return false;
+            }
+        }
+
+        player_t* p = get_player(g, (uint32_t)records[i].player);
+
+        if (!p) {
+            return false;
+        }
+
+        p->busy_fields = records[i].busy_fields;
+        p->boundary_length = records[i].boundary_length;
+        p->busy_areas = (uint32_t)records[i].busy_areas;
+        p->frontier = length > 0 ? frontier : NULL;
+        p->frontier_length = length;
+        p->frontier_capacity = length;
+        p->frontier_mapped = length > 0;
+        frontier += length;
+        update_blocked(g, (uint32_t)records[i].player);
+    }
+
+    return true;
+}
+
+// Copies the tiles of the sparse board from the mapped file to the new game.
+// Returns false if they are not correct or there is no memory for them.
+static bool load_tiles(game_t* g, char const* file, save_header_t const* h) {
+    char const* record = &file[h->board_offset];
+
+    for (uint64_t i = 0; i < h->tiles_count; i++) {
+        uint64_t key;
+
+        memcpy(&key, record, sizeof(uint64_t));
+
+        uint64_t x = (key >> 32) * TILE_SIDE;
+        uint64_t y = (key & UINT32_MAX) * TILE_SIDE;
+
+        if (x >= g->width || y >= g->height) {
+            return false;
+        }
+
+        tile_t* tile = get_tile(g, (uint32_t)x, (uint32_t)y);
+
+        if (!tile) {
+            return false;
+        }
+
+        memcpy(tile, record + sizeof(uint64_t), TILE_DATA_LENGTH);
+        record += sizeof(uint64_t) + TILE_DATA_LENGTH;
+
+        if (!correct_tile(g, tile, x, y)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** @brief The state of the recounting of the players of the loaded game
+ * from its board (see correct_counts):
+ * records         - the players table of the file,
+ * saved_players   - the length of records array,
+ * counted         - the numbers recounted for the players of records array,
+ * root_player     - root_player[c] is the player of the root c or zero if
+ *                   none of its fields is counted yet,
+ * taken           - the number of the counted taken fields.
+ */
+typedef struct Load_counts {
+    save_player_t const* records;
+    uint64_t saved_players;
+    save_player_t* counted;
+    uint32_t* root_player;
+    uint64_t taken;
+} load_counts_t;
+
+// Returns the index of the record of the player in the players table or
+// saved_players if the player is not saved. The records are sorted.
+static uint64_t record_index(load_counts_t const* lc, uint32_t player) {
+    uint64_t begin = 0;
+    uint64_t end = lc->saved_players;
+
+    while (begin < end) {
+        uint64_t middle = begin + (end - begin) / 2;
+
+        if (lc->records[middle].player < player) {
+            begin = middle + 1;
+        }
+        else {
+            end = middle;
+        }
+    }
+
+    return begin < lc->saved_players && lc->records[begin].player == player
+               ? begin
+               : lc->saved_players;
+}
+
+// Returns true if the field (x,y) is the first neighbour of the empty field
+// (column,row) taken by the player, so every field of the boundary of the
+// player is counted once.
+static bool first_neighbour(game_t const* g, uint32_t column, uint32_t row,
+                            uint32_t player, uint32_t x, uint32_t y) {
+    for (int i = 0; i < MAX_NEIGHBOURS; i++) {
+        uint32_t neighbour_x = column + (uint32_t)NEIGHBOUR_DX[i];
+        uint32_t neighbour_y = row + (uint32_t)NEIGHBOUR_DY[i];
+
+        if (neighbour_x == x && neighbour_y == y) {
+            return true;
+        }
+        if (correct_coordinate(g, neighbour_x, neighbour_y) &&
+            field_player(g, neighbour_x, neighbour_y) == player) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+// Counts the field (x,y) of the loaded game for its player: the field,
+// its area, if it is the first counted field of the area, and its empty
+// neighbours, which are on the boundary of the player. Returns false if
+// the owner of the field does not match its area or the field is joined
+// with a neighbour of the same player in a different area.
+static bool count_field(game_t const* g, load_counts_t* lc, uint32_t x, uint32_t y) {
+    uint32_t player = field_player(g, x, y);
+
+    if (player == 0) {
+        return true;
+    }
+
+    uint64_t index = record_index(lc, player);
+    area_t root = area_root(g, field_color(g, x, y));
+
+    if (index == lc->saved_players ||
+        (g->area_owner && field_owner(g, x, y) != owner_tag(player)) ||
+        (lc->root_player[root] != 0 && lc->root_player[root] != player)) {
+        return false;
+    }
+
+    save_player_t* counted = &lc->counted[index];
+
+    counted->busy_fields++;
+    lc->taken++;
+
+    if (lc->root_player[root] == 0) {
+        lc->root_player[root] = player;
+        counted->busy_areas++;
+    }
+
+    for (int i = 0; i < MAX_NEIGHBOURS; i++) {
+        uint32_t column = x + (uint32_t)NEIGHBOUR_DX[i];
+        uint32_t row = y + (uint32_t)NEIGHBOUR_DY[i];
+
+        if (!correct_coordinate(g, column, row)) {
+            continue;
+        }
+
+        uint32_t neighbour = field_player(g, column, row);
+
+        if (neighbour == player && area_root(g, field_color(g, column, row)) != root) {
+            return false;
+        }
+        if (neighbour == 0 && first_neighbour(g, column, row, player, x, y)) {
+            counted->boundary_length++;
+        }
+    }
+
+    return true;
+}
+
+// Returns true if the empty fields of the frontier of the player of the loaded
+// game are his boundary fields and there are boundary_length of them.
+static bool correct_frontier(game_t const* g, player_t const* p, uint32_t player) {
+    uint64_t empty = 0;
+
+    for (uint64_t i = 0; i < p->frontier_length; i++) {
+        uint32_t x = p->frontier[i].x;
+        uint32_t y = p->frontier[i].y;
+        bool boundary = false;
+
+        if (field_player(g, x, y) != 0) {
+            continue;
+        }
+
+        for (int j = 0; j < MAX_NEIGHBOURS; j++) {
+            uint32_t column = x + (uint32_t)NEIGHBOUR_DX[j];
+            uint32_t row = y + (uint32_t)NEIGHBOUR_DY[j];
+
+            boundary |= correct_coordinate(g, column, row) && field_player(g, column, row) == player;
+        }
+
+        if (!boundary) {
+            return false;
+        }
+
+        empty++;
+    }
+
+    return empty == p->boundary_length;
+}
+
+// Recounts the fields, the areas and the boundaries of the players of
+// the loaded game from its board and compares them with the players table
+// of the file. Returns false if they differ, the board does not match
+// the areas or there is no memory for the check.
+static bool correct_counts(game_t const* g, char const* file, save_header_t const* h) {
+    load_counts_t lc = {
+        .records = (save_player_t const*)&file[h->players_offset],
+        .saved_players = h->saved_players,
+        .counted = calloc(h->saved_players + 1, sizeof(save_player_t)),
+        .root_player = calloc(g->next_area, sizeof(uint32_t)),
+        .taken = 0,
+    };
+    bool success = lc.counted && lc.root_player;
+
+    if (success && !g->tiles) {
+        for (uint32_t y = 0; success && y < g->height; y++) {
+            owner_t const* row = &g->owners[field_index(g, 0, y)];
+
+            for (uint32_t x = 0; success && x < g->width; x++) {
+                success = row[x] == 0 || count_field(g, &lc, x, y);
+            }
+        }
+    }
+
+    for (uint64_t i = 0; success && i < g->tiles_capacity; i++) {
+        uint64_t key = g->tiles[i].key;
+        uint64_t first_x = (key >> 32) * TILE_SIDE;
+        uint64_t first_y = (key & UINT32_MAX) * TILE_SIDE;
+
+        if (!g->tiles[i].tile) {
+            continue;
+        }
+
+        for (uint64_t y = first_y; success && y < first_y + TILE_SIDE && y < g->height; y++) {
+            for (uint64_t x = first_x; success && x < first_x + TILE_SIDE && x < g->width; x++) {
+                success = count_field(g, &lc, (uint32_t)x, (uint32_t)y);
+            }
+        }
+    }
+
+    success = success && lc.taken + g->fields_to_take == (uint64_t)g->width * g->height;
+
+    for (uint64_t i = 0; success && i < lc.saved_players; i++) {
+        uint32_t player = (uint32_t)lc.records[i].player;
+
+        success = lc.counted[i].busy_fields == lc.records[i].busy_fields &&
+                  lc.counted[i].busy_areas == lc.records[i].busy_areas &&
+                  lc.counted[i].boundary_length == lc.records[i].boundary_length &&
+                  correct_frontier(g, read_player(g, player), player);
+    }
+
+    free(lc.counted);
+    free(lc.root_player);
+
+    return success;
+}
+
+game_t* game_load(int fd) {
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) != 0) {
+        return NULL;
+    }
+
+    uint64_t length = (uint64_t)file_stat.st_size;
+
+    if (length < sizeof(save_header_t)) {
+        errno = EINVAL;
+
+        return NULL;
+    }
+
+    // The mapping is private, so the moves of the game do not change the file.
+    char* file = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    if (file == MAP_FAILED) {
+        return NULL;
+    }
+
+    save_header_t const* h = (save_header_t const*)file;
+
+    if (!correct_save_header(h, length)) {
+        munmap(file, length);
+        errno = EINVAL;
+
+        return NULL;
+    }
+
+    game_t* g = new_game(h->width, h->height, h->number_of_players, h->max_areas, true);
+
+    errno = g ? 0 : ENOMEM;
+
+    if (g && (!load_players(g, file, h) || (h->sparse && !load_tiles(g, file, h)) ||
+              (!h->sparse && !correct_planes(g, (owner_t const*)&file[h->board_offset],
+                                             (area_t const*)&file[h->colors_offset])))) {
+        game_delete(g);
+        g = NULL;
+
+        if (errno != ENOMEM) {
+            errno = EINVAL;
+        }
+    }
+
+    if (!g) {
+        munmap(file, length);
+
+        return NULL;
+    }
+
+    // The dense board is used in place in the mapped file.
+    if (!h->sparse) {
+        free(g->tiles);
+        g->tiles = NULL;
+        g->tiles_capacity = 0;
+        g->owners = (owner_t*)&file[h->board_offset];
+        g->colors = (area_t*)&file[h->colors_offset];
+    }
+
+    g->mapping = file;
+    g->mapping_length = length;
+    errno = 0;
+
+    if (!correct_counts(g, file, h)) {
+        int error = errno == ENOMEM ? ENOMEM : EINVAL;
+
+        game_delete(g);
+        errno = error;
+
+        return NULL;
+    }
+
+    return g;
+}
+
+// Moves the planes of the dense board to the new shared planes. The board
+// becomes sparse without any tile, so all its fields are read from the shared
+// planes. The frontiers kept in the mapped file are copied, because the file
+// is unmapped together with the shared planes. Returns false if there is
+// no memory.
+static bool share_planes(game_t* g) {
+    for (uint32_t i = 1; i <= g->number_of_players; i++) {
+        if (!g->player_pages[(i - 1) >> PLAYERS_PAGE_BITS]) {
+            // The page is empty, so the next one starts after it.
+            i |= PLAYERS_PAGE - 1;
+            continue;
+        }
+
+        player_t* p = find_player(g, i);
+
+        if (p->frontier_mapped) {
+            game_field_t* frontier = malloc(p->frontier_length * sizeof(game_field_t));
+
+            if (!frontier) {
+                return false;
+            }
+
+            memcpy(frontier, p->frontier, p->frontier_length * sizeof(game_field_t));
+            p->frontier = frontier;
+            p->frontier_capacity = p->frontier_length;
+            p->frontier_mapped = false;
+        }
+    }
+
+    shared_planes_t* planes = malloc(sizeof(shared_planes_t));
+    tile_entry_t* tiles = calloc(INITIAL_TILES_CAPACITY, sizeof(tile_entry_t));
+
+    if (!planes || !tiles) {
+        free(planes);
+        free(tiles);
+
+        return false;
+    }
+
+    planes->owners = g->owners;
+    planes->colors = g->colors;
+    planes->plane_length = plane_length(g);
+    planes->mapping = g->mapping;
+    planes->mapping_length = g->mapping_length;
+    atomic_init(&planes->other_games, 0);
+
+    g->owners = NULL;
+    g->colors = NULL;
+    g->mapping = NULL;
+    g->mapping_length = 0;
+    g->tiles = tiles;
+    g->tiles_capacity = INITIAL_TILES_CAPACITY;
+    g->tiles_count = 0;
+    g->shared_planes = planes;
+
+    return true;
+}
+
+game_t* game_clone(game_t* g) {
+    if (!g || (!g->tiles && !share_planes(g))) {
+        return NULL;
+    }
+
+    game_t* c = malloc(sizeof(game_t));
+    uint64_t pages = player_pages_count(g);
+    players_page_t** player_pages = calloc(pages, sizeof(players_page_t*));
+
+    // The last level of the bitmap of the full pages has one word.
+    uint64_t full_words = g->full_offset[g->full_levels - 1] + 1;
+    uint64_t* full_pages = malloc(full_words * sizeof(uint64_t));
+    tile_entry_t* tiles = calloc(g->tiles_capacity, sizeof(tile_entry_t));
+    area_t* area_parent = malloc(g->areas_capacity * sizeof(area_t));
+    area_t* area_size = malloc(g->areas_capacity * sizeof(area_t));
+    uint32_t* area_owner = g->area_owner ? malloc(g->areas_capacity * sizeof(uint32_t)) : NULL;
+    bool success = c && player_pages && full_pages && tiles && area_parent && area_size &&
+                   (!g->area_owner || area_owner);
+
+    if (c) {
+        *c = *g;
+    }
+
+    // Only the pages of the players who moved are copied. The frontiers
+    // are copied, because they are changed by every move.
+    for (uint64_t page = 0; success && page < pages; page++) {
+        uint64_t length = page_players(g, page);
+
+        if (!g->player_pages[page]) {
+            continue;
+        }
+
+        player_t const* p = g->player_pages[page]->players;
+
+        player_pages[page] = calloc(1, sizeof(players_page_t) + length * sizeof(player_t));
+        success = player_pages[page] != NULL;
+
+        if (success) {
+            memcpy(player_pages[page]->blocked, g->player_pages[page]->blocked,
+                   sizeof(player_pages[page]->blocked));
+            player_pages[page]->blocked_count = g->player_pages[page]->blocked_count;
+        }
+
+        for (uint64_t i = 0; success && i < length; i++) {
+            player_t* copy = &player_pages[page]->players[i];
+
+            *copy = p[i];
+            copy->frontier = NULL;
+            copy->frontier_capacity = 0;
+            copy->frontier_mapped = false;
+
+            if (p[i].frontier_length > 0) {
+                game_field_t* frontier = malloc(p[i].frontier_length * sizeof(game_field_t));
+
+                success = frontier != NULL;
+
+                if (success) {
+                    memcpy(frontier, p[i].frontier, p[i].frontier_length * sizeof(game_field_t));
+                    copy->frontier = frontier;
+                    copy->frontier_capacity = p[i].frontier_length;
+                }
+            }
+        }
+    }
+
+    if (!success) {
+        remove_struct(c, player_pages, full_pages, NULL, NULL, 0, tiles, area_parent, area_size,
+                      area_owner);
+
+        return NULL;
+    }
+
+    memcpy(full_pages, g->full_pages, full_words * sizeof(uint64_t));
+
+    memcpy(area_parent, g->area_parent, g->next_area * sizeof(area_t));
+    memcpy(area_size, g->area_size, g->next_area * sizeof(area_t));
+
+    if (area_owner) {
+        memcpy(area_owner, g->area_owner, g->next_area * sizeof(uint32_t));
+    }
+
+    // The tiles and the planes are shared until one of the games changes them.
+    for (uint64_t i = 0; i < g->tiles_capacity; i++) {
+        tiles[i] = g->tiles[i];
+
+        if (tiles[i].tile) {
+            atomic_fetch_add(&tiles[i].tile->other_games, 1);
+        }
+    }
+
+    if (g->shared_planes) {
+        atomic_fetch_add(&g->shared_planes->other_games, 1);
+    }
+
+    c->player_pages = player_pages;
+    c->full_pages = full_pages;
+    c->tiles = tiles;
+    c->area_parent = area_parent;
+    c->area_size = area_size;
+    c->area_owner = area_owner;
+    c->bitboards = NULL;
+    c->bitboard_stride = 0;
+    c->bitboard_length = 0;
+    c->mapping = NULL;
+    c->mapping_length = 0;
+    c->journal = NULL;
+    c->history = NULL;
+#ifdef GAME_STATS
+    c->stats = (game_stats_t){0};
+#endif
+
+    return c;
+}
+
+bool find_next_player(game_t* g, uint32_t* current_player_number) {
+    uint32_t next = game_next_player(g, *current_player_number);
+
+    if (next == 0) {
+        return false;
+    }
+
+    *current_player_number = next;
+
+    return true;
+}
+
+void print_players_score(game_t* g) {
+    for (uint32_t i = 1; i <= game_players(g); i++) {
+        player_t const* p = read_player(g, i);
+
+        if (g->symbol_width == 0) {
+            printf("Player %c occupied %lu field(s) and %u area(s)\n",
+                   player_symbol(i), p->busy_fields, p->busy_areas);
+        }
+        else {
+            printf("Player %u occupied %lu field(s) and %u area(s)\n",
+                   i, p->busy_fields, p->busy_areas);
+        }
     }
 }
\ No newline at end of file
@@ -1,5 +1,12 @@
+#include "batch_mode.h"
+#include "computer_player.h"
 #include "game.h"
+#include "game_random.h"
 #include <ncurses.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 // This constant describes the ^D command.
 #define GAME_BREAK 4
@@ -46,6 +53,21 @@
 // The column of the upper left corner of the board.
 #define FIRST_COLUMN 0
 
+// The default time in milliseconds given to a computer player for a move.
+#define DEFAULT_THINKING_TIME 1000
+
+// The time in milliseconds between the refreshes of the screen while
+// a computer player is thinking.
+#define THINKING_REFRESH_TIME 20
+
+// The number of lines written by board_state below the board.
+#define STATE_LINES 6
+
+// The maximal number of players of the TUI mode: every field is shown
+// as one character, so only the players with one character symbols
+// can play.
+#define MAX_TUI_PLAYERS 61
+
 static void start_TUI_mode() {
 
     // Turn on the TUI mode.
@@ -71,9 +93,12 @@ static void end_TUI_mode() {
     reset_shell_mode();
 }
 
-// Checks the validity of game_in_TUI_mode parameters and updates the game parameters.
-static void check_game_parameters(const int argc, const char **argv, uint32_t* width, uint32_t* height,
-                           uint32_t* players, uint32_t* areas) {
+// Checks the validity of the game parameters starting from argv[first]
+// and updates the game parameters. The number of players is at most
+// max_players.
+static void check_game_parameters(const int argc, const char **argv, int first,
+                                  uint64_t max_players, uint32_t* width, uint32_t* height,
+                                  uint32_t* players, uint32_t* areas) {
 
     // The converted value is kept in converted_value.
     // A usage of strtoul convert function forces us to
@@ -85,46 +110,84 @@ static void check_game_parameters(const int argc, const char **argv, uint32_t* w
     char* end_string;
 
     // Check if the number of input arguments is correct.
-    if (argc != 5) {
-        fprintf(stderr, "Usage: %s <width> <height> <players> <areas>\n", argv[0]);
+    if (argc < first + 4) {
+        fprintf(stderr, "Usage: %s <width> <height> <players> <areas> "
+                        "[-c <player>]... [-t <milliseconds>]\n"
+                        "       %s -b <width> <height> <players> <areas>\n", argv[0], argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    converted_value = strtoul(argv[1], &end_string, 10);
+    converted_value = strtoul(argv[first], &end_string, 10);
 
     // Read the game_in_TUI_mode parameters and check their validity.
     if (*end_string != '\0' || converted_value > UINT32_MAX) {
-        fprintf(stderr, "Invalid width value: %s\n", argv[1]);
+        fprintf(stderr, "Invalid width value: %s\n", argv[first]);
         exit(EXIT_FAILURE);
     }
 
     *width = (uint32_t)converted_value;
-    converted_value = strtoul(argv[2], &end_string, 10);
+    converted_value = strtoul(argv[first + 1], &end_string, 10);
 
     if (*end_string != '\0' || converted_value > UINT32_MAX) {
-        fprintf(stderr, "Invalid height value: %s\n", argv[2]);
+        fprintf(stderr, "Invalid height value: %s\n", argv[first + 1]);
         exit(EXIT_FAILURE);
     }
 
     *height = (uint32_t)converted_value;
-    converted_value = strtoul(argv[3], &end_string, 10);
+    converted_value = strtoul(argv[first + 2], &end_string, 10);
 
-    if (*end_string != '\0' || converted_value > UINT32_MAX) {
-        fprintf(stderr, "Invalid players value: %s\n", argv[3]);
+    if (*end_string != '\0' || converted_value > max_players) {
+        fprintf(stderr, "Invalid players value: %s\n", argv[first + 2]);
         exit(EXIT_FAILURE);
     }
 
     *players = (uint32_t)converted_value;
-    converted_value = strtoul(argv[4], &end_string, 10);
+    converted_value = strtoul(argv[first + 3], &end_string, 10);
 
     if (*end_string != '\0' || converted_value > UINT32_MAX) {
-        fprintf(stderr, "Invalid areas value: %s\n", argv[4]);
+        fprintf(stderr, "Invalid areas value: %s\n", argv[first + 3]);
         exit(EXIT_FAILURE);
     }
 
     *areas = (uint32_t)converted_value;
 }
 
+// Reads the options following the game parameters: every "-c <player>" makes
+// the player a computer player and "-t <milliseconds>" sets the time of
+// thinking of the computer players. Marks the computer players in the array
+// computer of length players + 1.
+static void check_computer_players(const int argc, const char **argv, uint32_t players,
+                                   bool* computer, uint64_t* milliseconds) {
+    uint64_t converted_value;
+    char* end_string;
+
+    for (int i = 5; i < argc; i += 2) {
+        if (i + 1 == argc || (strcmp(argv[i], "-c") != 0 && strcmp(argv[i], "-t") != 0)) {
+            fprintf(stderr, "Invalid option: %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+
+        converted_value = strtoul(argv[i + 1], &end_string, 10);
+
+        if (argv[i][1] == 'c') {
+            if (*end_string != '\0' || converted_value == 0 || converted_value > players) {
+                fprintf(stderr, "Invalid computer player: %s\n", argv[i + 1]);
+                exit(EXIT_FAILURE);
+            }
+
+            computer[converted_value] = true;
+        }
+        else {
+            if (*end_string != '\0' || converted_value == 0) {
+                fprintf(stderr, "Invalid thinking time: %s\n", argv[i + 1]);
+                exit(EXIT_FAILURE);
+            }
+
+            *milliseconds = converted_value;
+        }
+    }
+}
+
 // Checks the size of the game board and if it is bigger
 // than size of user monitor returns false. Returns true otherwise.
 static bool check_screen(const uint32_t width, const uint32_t height) {
@@ -218,14 +281,152 @@ static void board_state(game_t const* g, uint32_t current_player_number) {
                                         game_general_free_fields(g));
 }
 
+/** @brief Chooses a random field on which the player can put a figure.
+ * @param g       - pointer on the game structure,
+ * @param player  - number of the player,
+ * @param seed    - pointer on the state of the random number generator,
+ * @param field   - pointer on the chosen field.
+ * @return True if the field was chosen and false if the player can not move.
+ */
+static bool random_legal_move(game_t* g, uint32_t player, uint64_t* seed, game_field_t* field) {
+    uint64_t count = game_free_fields(g, player);
+
+    if (count == 0) {
+        return false;
+    }
+
+    // The board of the TUI mode fits on the screen, so count fits in 32 bits.
+    uint32_t index = game_random_number(seed, (uint32_t)count);
+    game_legal_moves_iterator_t it;
+
+    game_legal_moves_begin(g, player, &it);
+
+    do {
+        if (!game_legal_moves_next(&it, field)) {
+            return false;
+        }
+    } while (index-- > 0);
+
+    return true;
+}
+
+/** @brief Lets the computer player make a move. The screen shows the number
+ * of the rollouts played so far and the user can end the game with ^D while
+ * the computer player is thinking. If the search fails, e.g. there is no
+ * memory for it, the computer player moves on a random field and the status
+ * line says so.
+ * @param g                 - pointer on the game structure,
+ * @param player            - number of the computer player,
+ * @param milliseconds      - time of thinking in milliseconds,
+ * @param seed              - pointer on the state of the random number
+ *                            generator of the random moves,
+ * @param failed            - set to true if no move could be made at all.
+ * @return True if the move was made and false if the user ended the game
+ * or no move could be made.
+ */
+static bool computer_move(game_t* g, uint32_t player, uint64_t milliseconds, uint64_t* seed,
+                          bool* failed) {
+    uint32_t height = game_board_height(g);
+    computer_player_t* c = computer_player_start(g, player, milliseconds);
+    bool ended = false;
+    bool searched = false;
+    game_field_t field;
+    uint64_t rollouts = 0;
+    double seconds = 0;
+
+    if (c) {
+        timeout(THINKING_REFRESH_TIME);
+
+        while (!computer_player_ready(c)) {
+            mvprintw(height + STATE_LINES, FIRST_COLUMN, "Player %c is thinking: %lu rollouts.",
+                     game_player(g, player), computer_player_rollouts(c));
+            clrtoeol();
+            refresh();
+
+            if (getch() == GAME_BREAK) {
+                computer_player_stop(c);
+                ended = true;
+            }
+        }
+
+        timeout(-1);
+        searched = computer_player_finish(c, &field, &rollouts, &seconds);
+
+        if (ended) {
+            return false;
+        }
+    }
+
+    if (searched && game_move(g, player, field.x, field.y)) {
+        mvprintw(height - 1 - field.y, field.x, "%c", game_player(g, player));
+        mvprintw(height + STATE_LINES, FIRST_COLUMN, "Player %c played %lu rollouts",
+                 game_player(g, player), rollouts);
+
+        // A search stopped at once may take no measurable time.
+        if (seconds > 0) {
+            printw(" (%.0f rollouts/s)", (double)rollouts / seconds);
+        }
+
+        printw(".");
+    }
+    else if (random_legal_move(g, player, seed, &field) &&
+             game_move(g, player, field.x, field.y)) {
+        mvprintw(height - 1 - field.y, field.x, "%c", game_player(g, player));
+        mvprintw(height + STATE_LINES, FIRST_COLUMN,
+                 "Player %c could not search the moves and moved at random.",
+                 game_player(g, player));
+    }
+    else {
+        *failed = true;
+        return false;
+    }
+
+    clrtoeol();
+
+    return true;
+}
+
+/** @brief Lets the computer players make their moves until a human player
+ * can move or the game ends.
+ * @param g                     - pointer on the game structure,
+ * @param computer              - computer[p] is true if p is a computer player,
+ * @param milliseconds          - time of thinking of the computer players,
+ * @param current_player_number - pointer on the number of current player,
+ * @param lets_play             - pointer on the game status,
+ * @param seed                  - pointer on the state of the random number
+ *                                generator of the random moves,
+ * @param failed                - set to true if a computer player could not move.
+ * @return False if the user ended the game or a computer player could not
+ * move and true otherwise.
+ */
+static bool computer_moves(game_t* g, bool const* computer, uint64_t milliseconds,
+                           uint32_t* current_player_number, bool* lets_play,
+                           uint64_t* seed, bool* failed) {
+    while (*lets_play && computer[*current_player_number]) {
+        if (!computer_move(g, *current_player_number, milliseconds, seed, failed)) {
+            return false;
+        }
+
+        if (!find_next_player(g, current_player_number)) {
+            *lets_play = false;
+        }
+
+        board_state(g, *current_player_number);
+        refresh();
+    }
+
+    return true;
+}
+
 /** Deal with the interactive game mode, prints the game board state, players
  * information, at the end of the procedure deletes all malloced data.
- * @param g  - pointer on the game structure.
+ * @param g             - pointer on the game structure,
+ * @param computer      - computer[p] is true if p is a computer player,
+ * @param milliseconds  - time of thinking of the computer players.
  */
-static void game_in_TUI_mode(game_t* g) {
+static void game_in_TUI_mode(game_t* g, bool const* computer, uint64_t milliseconds) {
     uint32_t width, height;
     int user_input;
-    char* result_board;
 
     width = game_board_width(g);
     height = game_board_height(g);
@@ -242,12 +443,21 @@ static void game_in_TUI_mode(game_t* g) {
     // put figures on the board.
     bool lets_play = true;
 
+    // Becomes true if a computer player could not make a move.
+    bool failed = false;
+
+    // The state of the generator of the random moves of the computer players,
+    // which differs from game to game.
+    uint64_t seed = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+
     // Move the cursor on the left upper corner.
     board_state(g, current_player_number);
+    bool playing = computer_moves(g, computer, milliseconds, &current_player_number,
+                                  &lets_play, &seed, &failed);
     move(current_row, current_column);
     refresh();
 
-    while (((user_input = getch()) != GAME_BREAK) && (lets_play == true)) {
+    while (playing && ((user_input = getch()) != GAME_BREAK) && (lets_play == true)) {
         switch (user_input) {
             case MOVE_SHIFT_LEFT:
             case MOVE_LEFT:
@@ -281,6 +491,8 @@ static void game_in_TUI_mode(game_t* g) {
                     }
 
                     board_state(g, current_player_number);
+                    playing = computer_moves(g, computer, milliseconds,
+                                             &current_player_number, &lets_play, &seed, &failed);
                     move(current_row, current_column);
                     refresh();
                 }
@@ -291,6 +503,8 @@ static void game_in_TUI_mode(game_t* g) {
             case 'C':
                 find_next_player(g, &current_player_number);
                 board_state(g, current_player_number);
+                playing = computer_moves(g, computer, milliseconds,
+                                         &current_player_number, &lets_play, &seed, &failed);
                 move(current_row, current_column);
                 refresh();
                 break;
@@ -302,21 +516,70 @@ static void game_in_TUI_mode(game_t* g) {
 
     end_TUI_mode();
 
-    // Print the game board and the player scores.
-    result_board = game_board(g);
-    printf("%s", result_board);
+    if (failed) {
+        fprintf(stderr, "A computer player could not make a move.\n");
+    }
+
+    // Print the game board and the player scores. The board is written
+    // in parts, so it does not have to fit in the memory at once.
+    fflush(stdout);
+
+    if (!game_board_write(g, STDOUT_FILENO)) {
+        fprintf(stderr, "Could not print the game board.\n");
+    }
+
     print_players_score(g);
 
     // Free all malloc data.
-    free(result_board);
     game_delete(g);
 }
 
+// Deals with the batch mode: the commands are read from the standard input
+// and the answers are written to the standard output (see batch_mode.h).
+// Returns the exit code of the program.
+static int game_in_batch_mode(const int argc, const char* argv[]) {
+    uint32_t width, height, players, areas;
+
+    // The batch mode has no screen, so the players are not limited
+    // by their symbols.
+    check_game_parameters(argc, argv, 2, UINT32_MAX, &width, &height, &players, &areas);
+
+    if (argc > 6) {
+        fprintf(stderr, "Invalid option: %s\n", argv[6]);
+
+        return 1;
+    }
+
+    game_t* g = game_new(width, height, players, areas);
+
+    if (!g) {
+        fprintf(stderr, "Invalid game parameters.\n");
+
+        return 1;
+    }
+
+    bool success = batch_mode_run(g, STDIN_FILENO, STDOUT_FILENO);
+
+    if (!success) {
+        perror("Batch mode failed");
+    }
+
+    game_delete(g);
+
+    return success ? 0 : 1;
+}
+
 int main(const int argc, const char* argv[]) {
     uint32_t width, height, players, areas;
+    uint64_t milliseconds = DEFAULT_THINKING_TIME;
+    bool* computer;
     game_t* g;
 
-    check_game_parameters(argc, argv, &width, &height, &players, &areas);
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+        return game_in_batch_mode(argc, argv);
+    }
+
+    check_game_parameters(argc, argv, 1, MAX_TUI_PLAYERS, &width, &height, &players, &areas);
     g = game_new(width, height, players, areas);
 
     if (!g) {
@@ -325,6 +588,17 @@ int main(const int argc, const char* argv[]) {
         return 1;
     }
 
+    computer = calloc((uint64_t)players + 1, sizeof(bool));
+
+    if (!computer) {
+        fprintf(stderr, "Not enough memory.\n");
+        game_delete(g);
+
+        return 1;
+    }
+
+    check_computer_players(argc, argv, players, computer, &milliseconds);
+
     // Start TUI mode also to check the screen size.
     start_TUI_mode();
 
@@ -333,7 +607,8 @@ int main(const int argc, const char* argv[]) {
     }
 
     print_empty_board(width, height);
-    game_in_TUI_mode(g);
+    game_in_TUI_mode(g, computer, milliseconds);
+    free(computer);
 
     return 0;
 }
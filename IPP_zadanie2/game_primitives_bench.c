@@ -0,0 +1,333 @@
+/** @file
+ * Micro-benchmarks of the internal functions of the engine.
+ *
+ * The file includes game.c, so the static functions can be called directly
+ * on prepared boards. The main board has two long snake areas of the first
+ * player which are joined by one field in the middle of the board, next to
+ * the areas of two other players. find_area is measured on a row of areas
+ * joined in pairs of the same size, which is the deepest forest union by
+ * size can build. Every function is called in batches on
+ * one processor (the process is pinned to it) after one batch warming up
+ * the caches, and the smallest number of cycles per call of all batches is
+ * written. On x86 the cycles are read with the time stamp counter, so they
+ * are cycles of its constant frequency; elsewhere the nanoseconds are
+ * written instead.
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+/**
+ * Funkcje sched_getcpu i sched_setaffinity są rozszerzeniami GNU.
+ */
+#define _GNU_SOURCE
+
+#include "game.c"
+#include <sched.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES_UNIT "cycles"
+#else
+#define CYCLES_UNIT "ns"
+#endif
+
+// Number of the measured batches of every function.
+#define BATCHES 9
+
+// Width and height of the board with the snakes.
+#define SNAKE_WIDTH 1024
+#define SNAKE_HEIGHT 65
+
+// Row of the field joining the snakes.
+#define JOINING_ROW (SNAKE_HEIGHT / 2)
+
+// Side of the full board of 61 players used by find_next_player.
+#define FULL_SIDE 16
+
+// Width of the row with the forest of areas measured by find_area.
+#define FOREST_WIDTH 1024
+
+// Maximal length of the path from a color to its root which is restored
+// before every call of find_area.
+#define MAX_PATH 64
+
+/** @brief The state of the measured calls:
+ * g            - the game,
+ * x, y, player - the field and the player of the calls,
+ * color        - the color given to find_area,
+ * path         - the colors on the path from color to its root (without
+ *                the root) and their parents before the path compression,
+ * path_length  - the number of the colors on the path,
+ * s, window, n - the surroundings and the neighbourhood of the field,
+ * sink         - the results of the calls, so they are not removed.
+ */
+typedef struct Bench {
+    game_t* g;
+    uint32_t x;
+    uint32_t y;
+    uint32_t player;
+    area_t color;
+    area_t path[MAX_PATH];
+    area_t parents[MAX_PATH];
+    uint32_t path_length;
+    surroundings_t s;
+    window_t window;
+    neighbourhood_t n;
+    uint64_t sink;
+} bench_t;
+
+// Returns the current number of cycles (or nanoseconds).
+static uint64_t cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+#endif
+}
+
+// Pins the process to the processor it runs on, so the caches stay warm
+// and the cycles are counted by one counter.
+static void pin_process(void) {
+    cpu_set_t set;
+    int cpu = sched_getcpu();
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu < 0 ? 0 : cpu, &set);
+
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        fprintf(stderr, "The process is not pinned to a processor.\n");
+    }
+}
+
+// Measures the function: calls it calls times in every batch and writes
+// the smallest number of cycles per call.
+static void measure(char const* name, void (*function)(bench_t*), bench_t* b,
+                    uint64_t calls) {
+    double best = 0;
+
+    // The first batch only warms up the caches.
+    for (int batch = 0; batch <= BATCHES; batch++) {
+        uint64_t start = cycles();
+
+        for (uint64_t i = 0; i < calls; i++) {
+            function(b);
+        }
+
+        double per_call = (double)(cycles() - start) / (double)calls;
+
+        if (batch == 1 || (batch > 1 && per_call < best)) {
+            best = per_call;
+        }
+    }
+
+    printf("%-36s %14.1f\n", name, best);
+}
+
+static void call_update_structure(bench_t* b) {
+    read_surroundings(b->g, b->x, b->y, &b->window, &b->s);
+    update_structure(b->g, &b->n, &b->s, b->x, b->y);
+    b->sink += b->n.length_diff_pair_neighbour;
+}
+
+static void call_check_non_direct_neighbours(bench_t* b) {
+    b->sink += check_non_direct_neighbours(&b->s, b->player);
+}
+
+static void call_find_area(bench_t* b) {
+    // Every call finds the root at the end of the whole path, so the path
+    // compression of the previous call is undone.
+    for (uint32_t i = 0; i < b->path_length; i++) {
+        b->g->area_parent[b->path[i]] = b->parents[i];
+    }
+
+    b->sink += find_area(b->g, b->color);
+}
+
+static void call_joining_move(bench_t* b) {
+    b->sink += make_move(b->g, b->player, b->x, b->y);
+    b->sink += undo_move(b->g, b->g->history);
+}
+
+static void call_find_next_player(bench_t* b) {
+    uint32_t player = b->player;
+
+    b->sink += find_next_player(b->g, &player);
+}
+
+static void call_game_board(bench_t* b) {
+    char* board = game_board(b->g);
+
+    b->sink += (uint64_t)board[0];
+    free(board);
+}
+
+// Fills the row y from x = begin to x = end - 1 with the figures of the player.
+static void fill_row(game_t* g, uint32_t player, uint32_t y, uint32_t begin, uint32_t end) {
+    for (uint32_t x = begin; x < end; x++) {
+        game_move(g, player, x, y);
+    }
+}
+
+// Creates a snake of the first player in the rows from first to last - 1:
+// the even rows (counted from first) are full and they are joined by one field
+// at the right and the left end of the odd rows in turn. The rows are taken
+// before the joining fields, so the snake is joined from many areas.
+static void make_snake(game_t* g, uint32_t first, uint32_t last) {
+    for (uint32_t y = first; y < last; y += 2) {
+        fill_row(g, 1, y, 0, SNAKE_WIDTH);
+    }
+
+    for (uint32_t y = first + 1; y < last; y += 2) {
+        game_move(g, 1, (y - first) % 4 == 1 ? SNAKE_WIDTH - 1 : 0, y);
+    }
+}
+
+// Creates the board with the snakes. The upper snake ends with the field
+// above the joining field and the lower snake with the field below it.
+// The rest of the rows around the joining field belongs to the second
+// and the third player.
+static game_t* snake_game(void) {
+    game_t* g = game_new(SNAKE_WIDTH, SNAKE_HEIGHT, 3, UINT32_MAX);
+    uint32_t middle = SNAKE_WIDTH / 2;
+
+    if (!g) {
+        return NULL;
+    }
+
+    make_snake(g, 0, JOINING_ROW - 1);
+    make_snake(g, JOINING_ROW + 2, SNAKE_HEIGHT);
+    game_move(g, 1, middle, JOINING_ROW - 1);
+    game_move(g, 1, middle, JOINING_ROW + 1);
+    fill_row(g, 3, JOINING_ROW - 1, 0, SNAKE_WIDTH);
+    fill_row(g, 3, JOINING_ROW + 1, 0, SNAKE_WIDTH);
+    fill_row(g, 2, JOINING_ROW, 0, middle);
+    fill_row(g, 2, JOINING_ROW, middle + 1, SNAKE_WIDTH);
+
+    return g;
+}
+
+// Creates the row in which the single fields of the first player are joined
+// in pairs, then the pairs in pairs and so on. The joined areas have
+// the same size, so every join makes the forest one level deeper.
+static game_t* forest_game(void) {
+    game_t* g = game_new(FOREST_WIDTH, 1, 1, UINT32_MAX);
+
+    if (!g) {
+        return NULL;
+    }
+
+    for (uint32_t x = 0; x < FOREST_WIDTH; x += 2) {
+        game_move(g, 1, x, 0);
+    }
+
+    for (uint32_t span = 2; span < FOREST_WIDTH; span *= 2) {
+        for (uint32_t x = 0; x + span < FOREST_WIDTH; x += 2 * span) {
+            game_move(g, 1, x + span - 1, 0);
+        }
+    }
+
+    return g;
+}
+
+// Finds the deepest color of the forest and saves its path to the root.
+static void save_deepest_path(bench_t* b) {
+    for (area_t color = 1; color < b->g->next_area; color++) {
+        uint32_t length = 0;
+
+        for (area_t c = color; b->g->area_parent[c] != c; c = b->g->area_parent[c]) {
+            length++;
+        }
+
+        if (length > b->path_length && length <= MAX_PATH) {
+            b->color = color;
+            b->path_length = length;
+        }
+    }
+
+    area_t c = b->color;
+
+    for (uint32_t i = 0; i < b->path_length; i++) {
+        b->path[i] = c;
+        b->parents[i] = b->g->area_parent[c];
+        c = b->parents[i];
+    }
+}
+
+// Creates the full board of 61 players, so none of them can move.
+static game_t* full_game(void) {
+    game_t* g = game_new(FULL_SIDE, FULL_SIDE, 61, UINT32_MAX);
+
+    if (!g) {
+        return NULL;
+    }
+
+    for (uint32_t y = 0; y < FULL_SIDE; y++) {
+        for (uint32_t x = 0; x < FULL_SIDE; x++) {
+            game_move(g, (x + y * FULL_SIDE) % 61 + 1, x, y);
+        }
+    }
+
+    return g;
+}
+
+int main() {
+    bench_t b = {0};
+    game_t* snakes = snake_game();
+    game_t* full = full_game();
+    game_t* forest = forest_game();
+
+    if (!snakes || !full || !forest || !game_history_enable(snakes)) {
+        fprintf(stderr, "Not enough memory.\n");
+
+        return 1;
+    }
+
+    // The snakes have to be two areas joined by the measured move.
+    if (find_player(snakes, 1)->busy_areas != 2) {
+        fprintf(stderr, "The snakes are not two areas.\n");
+
+        return 1;
+    }
+
+    pin_process();
+    printf("%-36s %14s\n", "function", CYCLES_UNIT " per call");
+
+    b.g = snakes;
+    b.x = SNAKE_WIDTH / 2;
+    b.y = JOINING_ROW;
+    b.player = 1;
+
+    measure("update_structure (4 neighbours)", call_update_structure, &b, 1 << 20);
+    measure("check_non_direct_neighbours", call_check_non_direct_neighbours, &b, 1 << 22);
+    measure("make_move + undo (snakes joined)", call_joining_move, &b, 1 << 20);
+    measure("game_board (1024x65)", call_game_board, &b, 1 << 10);
+
+    b.g = forest;
+    save_deepest_path(&b);
+
+    char name[40];
+
+    snprintf(name, sizeof(name), "find_area (path of %u)", b.path_length);
+    measure(name, call_find_area, &b, 1 << 22);
+
+    b.g = full;
+    b.player = 1;
+
+    measure("find_next_player (61 players, none)", call_find_next_player, &b, 1 << 18);
+
+    printf("checksum %lu\n", b.sink);
+
+    game_delete(snakes);
+    game_delete(full);
+    game_delete(forest);
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+/** @file
+ * Interfejs generatora pseudolosowych ruchów używanego przez tryb
+ * interaktywny, gdy gracz komputerowy nie może przeszukać ruchów.
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+#ifndef GAME_RANDOM_H
+#define GAME_RANDOM_H
+
+#include "game.h"
+
+/** @brief Losuje liczbę.
+ * Przesuwa stan @p seed liniowego generatora kongruencyjnego i wyznacza
+ * z jego starszych bitów liczbę.
+ * @param[in,out] seed – wskaźnik na stan generatora,
+ * @param[in] bound    – dodatnie ograniczenie losowanej liczby.
+ * @return Liczba z przedziału od 0 do @p bound - 1.
+ */
+uint32_t game_random_number(uint64_t *seed, uint32_t bound);
+
+/** @brief Losuje ruch.
+ * Losuje kolejno numer gracza i współrzędne pola. Ograniczenia mogą
+ * przekraczać rozmiary gry, jeśli losowane mają być także błędne ruchy.
+ * @param[in,out] seed – wskaźnik na stan generatora,
+ * @param[in] players  – dodatnia liczba graczy,
+ * @param[in] width    – dodatnia szerokość planszy,
+ * @param[in] height   – dodatnia wysokość planszy.
+ * @return Ruch gracza z przedziału od 1 do @p players na pole, którego
+ * współrzędne są mniejsze niż @p width i @p height.
+ */
+game_move_t game_random_move(uint64_t *seed, uint32_t players, uint32_t width,
+                             uint32_t height);
+
+#endif /* GAME_RANDOM_H */
@@ -8,6 +8,9 @@
 
 /**
  * To jest deklaracja struktury przechowującej stan gry.
+ * Cały stan gry jest przechowywany w tej strukturze, więc różne gry są od
+ * siebie niezależne i mogą być jednocześnie rozgrywane w różnych wątkach.
+ * Jednej gry nie wolno modyfikować jednocześnie w kilku wątkach.
  */
 typedef struct game game_t;
 
@@ -17,7 +20,9 @@ typedef struct game game_t;
  * Gdy nie udało się alokować pamięci, ustawia @p errno na @p ENOMEM.
  * @param[in] width   – szerokość planszy, liczba dodatnia,
  * @param[in] height  – wysokość planszy, liczba dodatnia,
- * @param[in] players – liczba graczy, liczba dodatnia,
+ * @param[in] players – liczba graczy, liczba dodatnia; gdy jest większa
+ *                      od 61, gracze są oznaczani na planszy numerami
+ *                      (zob. @ref game_board),
  * @param[in] areas   – maksymalna liczba obszarów, które może zająć jeden
  *                      gracz, liczba dodatnia.
  * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się alokować
@@ -26,6 +31,48 @@ typedef struct game game_t;
 game_t* game_new(uint32_t width, uint32_t height,
                  uint32_t players, uint32_t areas);
 
+/** @brief Tworzy strukturę przechowującą stan gry na rzadkiej planszy.
+ * Działa tak samo jak funkcja @ref game_new, ale plansza jest podzielona na
+ * kwadratowe kawałki, które są alokowane dopiero wtedy, gdy zostanie zajęte
+ * pierwsze ich pole. Pamięć zajmowana przez grę zależy więc od liczby zajętych
+ * pól, a nie od rozmiaru planszy, ale ruchy są wolniejsze. Funkcja
+ * @ref game_new sama tworzy taką planszę, jeśli zwykła byłaby za duża.
+ * Gdy nie udało się alokować pamięci, ustawia @p errno na @p ENOMEM.
+ * @param[in] width   – szerokość planszy, liczba dodatnia,
+ * @param[in] height  – wysokość planszy, liczba dodatnia,
+ * @param[in] players – liczba graczy, liczba dodatnia,
+ * @param[in] areas   – maksymalna liczba obszarów, które może zająć jeden
+ *                      gracz, liczba dodatnia.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się alokować
+ * pamięci lub któryś z parametrów jest niepoprawny.
+ */
+game_t* game_new_sparse(uint32_t width, uint32_t height,
+                        uint32_t players, uint32_t areas);
+
+/** @brief Tworzy kopię stanu gry.
+ * Tworzy strukturę przechowującą taki sam stan gry jak @p g, której ruchy
+ * nie zmieniają gry @p g i odwrotnie. Obie gry współdzielą planszę
+ * podzieloną na kwadraty 32 x 32 pól, a gra kopiuje kwadrat dopiero wtedy,
+ * gdy zajmuje pole, które do niego należy. Dlatego czas działania i zajęta
+ * pamięć nie zależą od rozmiaru planszy, tylko od liczby obszarów i długości
+ * brzegów obszarów graczy. Zwykła plansza gry @p g zamieniana jest na
+ * podzieloną na kwadraty. Dopóki plansza jest współdzielona, ruchy wszystkich
+ * tych gier są wolniejsze: każdy z nich szuka kwadratów w tablicy
+ * mieszającej, więc na dużej planszy gra wykonuje nawet trzy razy mniej
+ * ruchów na sekundę. Gdy pozostałe gry zostaną usunięte, pierwszy ruch
+ * ostatniej z nich przepisuje jej kwadraty z powrotem do zwykłej planszy
+ * w czasie proporcjonalnym do liczby zajętych kwadratów.
+ * Kopia nie ma włączonych bitboardów, nie zapisuje dziennika ruchów i nie ma
+ * historii ruchów.
+ * Gry mające wspólną planszę mogą być używane w różnych wątkach, ale
+ * podczas wywołania tej funkcji gra @p g nie może być używana przez inne
+ * wątki.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się alokować
+ * pamięci lub wskaźnik @p g ma wartość NULL.
+ */
+game_t* game_clone(game_t *g);
+
 /** @brief Usuwa strukturę przechowującą stan gry.
  * Usuwa z pamięci strukturę wskazywaną przez @p g.
  * Nic nie robi, jeśli wskaźnik ten ma wartość NULL.
@@ -48,6 +95,31 @@ void game_delete(game_t* g);
  */
 bool game_move(game_t *g, uint32_t player, uint32_t x, uint32_t y);
 
+/**
+ * To jest struktura opisująca jeden ruch przekazywany do funkcji
+ * @ref game_move_batch.
+ */
+typedef struct game_move_data {
+    uint32_t player; ///< Numer gracza wykonującego ruch.
+    uint32_t x;      ///< Numer kolumny pola.
+    uint32_t y;      ///< Numer wiersza pola.
+} game_move_t;
+
+/** @brief Wykonuje ciąg ruchów.
+ * Wykonuje po kolei ruchy z tablicy @p moves. Daje taki sam wynik jak
+ * @p count kolejnych wywołań funkcji @ref game_move, ale sprawdza wskaźnik
+ * @p g tylko raz i wcześniej sięga do pól planszy kolejnych ruchów.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] moves   – tablica ruchów do wykonania,
+ * @param[in] count   – liczba ruchów w tablicy @p moves,
+ * @param[out] results – tablica o długości @p count, w której na pozycji
+ *                      @p i umieszczany jest wynik funkcji @ref game_move
+ *                      dla ruchu @p moves[i], lub NULL.
+ * @return Liczba wykonanych ruchów.
+ */
+uint64_t game_move_batch(game_t *g, game_move_t const *moves, uint64_t count,
+                         bool *results);
+
 /** @brief Podaje liczbę pól zajętych przez gracza.
  * Podaje liczbę pól zajętych przez gracza @p player.
  * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
@@ -69,6 +141,123 @@ uint64_t game_busy_fields(game_t const *g, uint32_t player);
  */
 uint64_t game_free_fields(game_t const *g, uint32_t player);
 
+/** @brief Sprawdza, czy któryś z graczy może wykonać ruch.
+ * Gracz nie może wykonać ruchu, gdy nie ma wolnych pól lub gdy zajął już
+ * wszystkie obszary i żadne wolne pole nie sąsiaduje z jego polami. Silnik
+ * zna liczbę takich graczy, więc funkcja działa w czasie stałym i pozwala
+ * wykryć koniec gry.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli któryś z graczy może wykonać ruch, a @p false
+ * w przeciwnym przypadku lub gdy wskaźnik @p g ma wartość NULL.
+ */
+bool game_any_player_can_move(game_t const *g);
+
+/** @brief Podaje kolejnego gracza, który może wykonać ruch.
+ * Szuka gracza, dla którego funkcja @ref game_free_fields daje wynik
+ * niezerowy, zaczynając od gracza o numerze @p player + 1 i przechodząc
+ * po ostatnim graczu do pierwszego, tak że gracz @p player jest sprawdzany
+ * na końcu. Czas działania nie zależy od liczby graczy, którzy nie mogą
+ * wykonać ruchu.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza; gdy jest niepoprawny, szukanie zaczyna
+ *                      się od pierwszego gracza.
+ * @return Numer znalezionego gracza lub zero, gdy żaden gracz nie może wykonać
+ * ruchu lub wskaźnik @p g ma wartość NULL.
+ */
+uint32_t game_next_player(game_t const *g, uint32_t player);
+
+/**
+ * To jest struktura opisująca jedno pole planszy, zwracana przez funkcje
+ * @ref game_legal_moves i @ref game_legal_moves_next.
+ */
+typedef struct game_field {
+    uint32_t x;      ///< Numer kolumny pola.
+    uint32_t y;      ///< Numer wiersza pola.
+} game_field_t;
+
+/**
+ * To jest struktura iteratora po polach, na których gracz może postawić
+ * pionek w następnym ruchu. Iterator jest unieważniany przez każdy ruch
+ * wykonany w grze. Jej pól nie należy zmieniać poza funkcjami
+ * @ref game_legal_moves_begin i @ref game_legal_moves_next.
+ */
+typedef struct game_legal_moves_iterator {
+    game_t const *g;  ///< Wskaźnik na strukturę przechowującą stan gry.
+    uint32_t player;  ///< Numer gracza.
+    bool whole_board; ///< Czy gracz może zająć każde wolne pole planszy.
+    uint64_t position; ///< Pozycja następnego sprawdzanego pola.
+} game_legal_moves_iterator_t;
+
+/** @brief Podaje pola, na których gracz może postawić pionek.
+ * Umieszcza w tablicy @p fields co najwyżej @p capacity pól, na których
+ * w danym stanie gry gracz @p player może postawić swój pionek w następnym
+ * ruchu. Jeśli gracz zajął już maksymalną liczbę obszarów, to czas działania
+ * jest proporcjonalny do liczby tych pól, a w przeciwnym przypadku do
+ * rozmiaru planszy.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref game_new,
+ * @param[out] fields – tablica o długości co najmniej @p capacity,
+ * @param[in] capacity – maksymalna liczba umieszczanych pól.
+ * @return Liczba wszystkich takich pól, czyli wartość funkcji
+ * @ref game_free_fields. Jeśli jest większa od @p capacity, to w tablicy
+ * umieszczone zostało tylko @p capacity pierwszych pól.
+ */
+uint64_t game_legal_moves(game_t const *g, uint32_t player,
+                          game_field_t *fields, uint64_t capacity);
+
+/** @brief Rozpoczyna przeglądanie pól, na których gracz może postawić pionek.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref game_new,
+ * @param[out] it     – wskaźnik na inicjowany iterator.
+ */
+void game_legal_moves_begin(game_t const *g, uint32_t player,
+                            game_legal_moves_iterator_t *it);
+
+/** @brief Podaje kolejne pole, na którym gracz może postawić pionek.
+ * @param[in,out] it  – wskaźnik na iterator zainicjowany funkcją
+ *                      @ref game_legal_moves_begin,
+ * @param[out] field  – wskaźnik, pod którym umieszczane jest pole.
+ * @return Wartość @p true, jeśli umieszczono kolejne pole, a @p false,
+ * jeśli wszystkie pola zostały już podane lub parametry iteratora są
+ * niepoprawne.
+ */
+bool game_legal_moves_next(game_legal_moves_iterator_t *it, game_field_t *field);
+
+/** @brief Włącza upakowane mapy bitowe planszy.
+ * Alokuje dla każdego gracza mapę bitową jego pól oraz mapę bitową wolnych
+ * pól i od tej pory uaktualnia je przy każdym ruchu. Dzięki nim funkcja
+ * @ref game_frontier przegląda całą planszę po 64 pola naraz (z użyciem
+ * instrukcji AVX2 lub SSE2, jeśli procesor je ma). Mapy zajmują
+ * (@p players + 1) * @p width * @p height / 8 bajtów, więc nie są domyślnie
+ * włączone i nie można ich włączyć dla rzadkiej planszy (zob.
+ * @ref game_new_sparse). Gdy nie udało się alokować pamięci lub plansza jest
+ * rzadka, ustawia @p errno na @p ENOMEM.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli mapy bitowe są włączone, a @p false,
+ * gdy nie udało się alokować pamięci, plansza jest rzadka lub wskaźnik @p g
+ * ma wartość NULL.
+ */
+bool game_bitboards_enable(game_t *g);
+
+/** @brief Podaje wolne pola sąsiadujące z pionkami gracza.
+ * Umieszcza w tablicy @p fields co najwyżej @p capacity wolnych pól, które
+ * sąsiadują z jakimś polem zajętym przez gracza @p player. Jeśli włączone są
+ * mapy bitowe (zob. @ref game_bitboards_enable), pola są podawane wierszami
+ * w kolejności rosnących numerów kolumn, a w przeciwnym przypadku w dowolnej
+ * kolejności.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref game_new,
+ * @param[out] fields – tablica o długości co najmniej @p capacity,
+ * @param[in] capacity – maksymalna liczba umieszczanych pól.
+ * @return Liczba wszystkich takich pól lub zero, jeśli któryś z parametrów
+ * jest niepoprawny lub wskaźnik @p g ma wartość NULL.
+ */
+uint64_t game_frontier(game_t const *g, uint32_t player,
+                       game_field_t *fields, uint64_t capacity);
+
 /** Podaje szerokość planszy.
  * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
  * @return Szerokość planszy lub zero, gdy wskaźnik @p g ma wartość NULL.
@@ -92,14 +281,19 @@ uint32_t game_players(game_t const *g);
  * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
  *                      @p players z funkcji @ref game_new.
  * @return Cyfra, litera lub inny jednoznakowy symbol gracza. Symbol oznaczający
- * puste pole, gdy numer gracza jest niepoprawny lub wskaźnik @p g ma wartość
- * NULL.
+ * puste pole, gdy numer gracza jest niepoprawny, wskaźnik @p g ma wartość
+ * NULL lub gra ma więcej niż 61 graczy, bo wtedy gracze nie mają
+ * jednoznakowych symboli.
  */
 char game_player(game_t const *g, uint32_t player);
 
 /** @brief Daje napis opisujący stan planszy.
  * Alokuje w pamięci bufor, w którym umieszcza napis zawierający tekstowy
  * opis aktualnego stanu planszy. Przykład znajduje się w pliku game_example.c.
+ * Gdy gra ma więcej niż 61 graczy, każde pole jest opisane numerem gracza
+ * wyrównanym do prawej do szerokości numeru ostatniego gracza lub kropką
+ * na tej samej szerokości, gdy pole jest puste, po którym jest spacja
+ * lub, na końcu wiersza, znak nowej linii.
  * Gdy nie udało się alokować pamięci, ustawia @p errno na @p ENOMEM.
  * Funkcja wywołująca musi zwolnić ten bufor.
  * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
@@ -108,5 +302,226 @@ char game_player(game_t const *g, uint32_t player);
  */
 char* game_board(game_t const *g);
 
+/** @brief Zapisuje napis opisujący stan planszy do bufora.
+ * Umieszcza w buforze @p buffer taki sam napis jak funkcja @ref game_board,
+ * ale nie alokuje pamięci. Jeśli bufor jest za krótki, nic w nim nie zapisuje.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] buffer – bufor o długości co najmniej @p length lub NULL,
+ *                      gdy @p length jest równe zero,
+ * @param[in] length  – długość bufora @p buffer.
+ * @return Długość napisu wraz z kończącym go znakiem '\0' lub zero, gdy
+ * wskaźnik @p g ma wartość NULL. Napis został zapisany wtedy i tylko wtedy,
+ * gdy wynik jest niezerowy i niewiększy od @p length.
+ */
+uint64_t game_board_into(game_t const *g, char *buffer, uint64_t length);
+
+/** @brief Zapisuje napis opisujący stan planszy do pliku.
+ * Zapisuje do deskryptora @p fd taki sam napis jak funkcja @ref game_board,
+ * ale bez kończącego go znaku '\0'. Napis jest tworzony w kawałkach przez
+ * kilka wątków i zapisywany po kolei funkcją @p writev, więc zajmowana
+ * pamięć nie zależy od rozmiaru planszy. W trakcie działania funkcji stanu
+ * gry nie wolno zmieniać. Gdy nie udało się alokować pamięci lub zapisać
+ * napisu, pozostawia ustawioną wartość @p errno.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] fd      – deskryptor pliku otwartego do zapisu.
+ * @return Wartość @p true, jeśli cały napis został zapisany, a @p false,
+ * gdy wystąpił błąd lub wskaźnik @p g ma wartość NULL.
+ */
+bool game_board_write(game_t const *g, int fd);
+
+/** @brief Zapisuje stan gry do pliku.
+ * Zapisuje do deskryptora @p fd cały stan gry w formacie binarnym, z którego
+ * funkcja @ref game_load odtwarza dokładnie ten sam stan gry. Plik zawiera
+ * nagłówek z numerem wersji formatu, tablicę graczy, obszary oraz planszę.
+ * Liczby są zapisywane w kolejności bajtów komputera, na którym działa
+ * program. Gdy nie udało się zapisać pliku, pozostawia ustawioną wartość
+ * @p errno.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] fd      – deskryptor pliku otwartego do zapisu.
+ * @return Wartość @p true, jeśli stan gry został zapisany, a @p false,
+ * gdy wystąpił błąd lub wskaźnik @p g ma wartość NULL.
+ */
+bool game_save(game_t const *g, int fd);
+
+/** @brief Odtwarza stan gry z pliku.
+ * Tworzy strukturę przechowującą stan gry zapisany funkcją @ref game_save
+ * w pliku o deskryptorze @p fd. Plik jest odwzorowywany w pamięć i zwykła
+ * plansza jest używana bezpośrednio z niego, bez kopiowania. Przed użyciem
+ * cały plik jest sprawdzany w czasie proporcjonalnym do jego długości:
+ * właściciele i obszary pól, puste obrzeże planszy, pola brzegów graczy,
+ * to, że obszary tworzą las, który mogło zbudować łączenie według rozmiaru,
+ * oraz liczby pól, obszarów i pól brzegu graczy, policzone ponownie
+ * z planszy. Zmiany stanu gry nie są zapisywane
+ * w pliku, ale pliku nie wolno zmieniać, dopóki gra nie zostanie usunięta.
+ * Deskryptor można zamknąć zaraz po wywołaniu funkcji. Gdy nie udało się
+ * alokować pamięci, ustawia @p errno na @p ENOMEM, a gdy plik nie jest
+ * poprawnym zapisem stanu gry, na @p EINVAL.
+ * @param[in] fd      – deskryptor pliku otwartego do odczytu.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy wystąpił błąd.
+ */
+game_t* game_load(int fd);
+
+/** @brief Włącza zapisywanie dziennika ruchów.
+ * Od tej chwili każde wywołanie funkcji @ref game_move (także wewnątrz
+ * @ref game_move_batch) dopisuje do dziennika rekord opisujący ruch i jego
+ * wynik. Rekordy są gromadzone w buforze i zapisywane do pliku
+ * o deskryptorze @p fd blokami po 8192 rekordy. Dziennik zaczyna się nagłówkiem:
+ * 8 bajtów "IPPMOVE\0", a po nich liczby 32-bitowe: wersja formatu (1),
+ * znacznik kolejności bajtów 0x01020304 oraz parametry @p width, @p height,
+ * @p players i @p areas gry. Liczby są zapisane w kolejności bajtów maszyny.
+ * Każdy rekord zaczyna się bajtem, którego bit 0 jest wynikiem ruchu, a bity
+ * 1–2, 3–4 i 5–6 są liczbami bajtów pomniejszonymi o jeden, na których
+ * zapisano kolejno @p player, @p x oraz @p y. Po nim są te liczby zapisane
+ * od najmłodszego bajtu, każda na najmniejszej liczbie bajtów (co najmniej
+ * jednym), na jakiej się mieści. Wywołania funkcji @ref game_undo,
+ * @ref game_redo, @ref game_history_enable i @ref game_history_disable
+ * zapisywane są jako jeden bajt: 0x80 | (rodzaj << 1) | wynik, gdzie rodzaj
+ * wynosi odpowiednio 1, 2, 3 i 4. Ruchy z dziennika odtwarzają
+ * grę, jeśli zapisywanie zostało włączone zaraz po utworzeniu gry. Gdy nie
+ * udało się alokować pamięci, ustawia @p errno na @p ENOMEM, a gdy dziennik
+ * jest już zapisywany, na @p EINVAL.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] fd      – deskryptor pliku otwartego do zapisu.
+ * @return Wartość @p true, jeśli zapisywanie dziennika zostało włączone,
+ * a @p false, gdy wystąpił błąd lub wskaźnik @p g ma wartość NULL.
+ */
+bool game_journal_start(game_t *g, int fd);
+
+/** @brief Kończy zapisywanie dziennika ruchów.
+ * Zapisuje rekordy pozostałe w buforze i wyłącza zapisywanie dziennika
+ * włączone funkcją @ref game_journal_start. Deskryptor nie jest zamykany.
+ * Funkcja @ref game_delete wywołuje ją, jeśli dziennik jest zapisywany.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli cały dziennik został zapisany, a @p false,
+ * gdy zapis się nie udał (wtedy @p errno opisuje błąd), dziennik nie był
+ * zapisywany lub wskaźnik @p g ma wartość NULL.
+ */
+bool game_journal_stop(game_t *g);
+
+/** @brief Włącza historię ruchów.
+ * Od tej chwili każdy wykonany ruch jest zapamiętywany razem ze zmianami
+ * stanu gry, których nie da się odtworzyć z planszy, więc można go cofnąć
+ * funkcją @ref game_undo. Historia zajmuje kilkadziesiąt bajtów na ruch.
+ * Dopóki jest włączona, tablice wolnych pól sąsiadujących z pionkami graczy
+ * nie są porządkowane, więc funkcja @ref game_legal_moves może pomijać więcej
+ * zajętych pól. Gdy nie udało się alokować pamięci, ustawia @p errno na
+ * @p ENOMEM.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli historia jest włączona, a @p false,
+ * gdy nie udało się alokować pamięci lub wskaźnik @p g ma wartość NULL.
+ */
+bool game_history_enable(game_t *g);
+
+/** @brief Wyłącza historię ruchów.
+ * Zwalnia historię włączoną funkcją @ref game_history_enable. Wykonanych
+ * ruchów nie można potem cofnąć.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ */
+void game_history_disable(game_t *g);
+
+/** @brief Cofa ostatni ruch.
+ * Przywraca stan gry sprzed ostatniego ruchu zapamiętanego w historii
+ * (zob. @ref game_history_enable). Koszt cofnięcia jest taki sam jak koszt
+ * ruchu. Cofnięte ruchy można wykonać ponownie funkcją @ref game_redo,
+ * dopóki nie zostanie wykonany inny ruch.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli ruch został cofnięty, a @p false, gdy
+ * historia nie jest włączona lub jest pusta, nie udało się alokować pamięci
+ * lub wskaźnik @p g ma wartość NULL.
+ */
+bool game_undo(game_t *g);
+
+/** @brief Wykonuje ponownie cofnięty ruch.
+ * Wykonuje ostatni ruch cofnięty funkcją @ref game_undo.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli ruch został wykonany, a @p false, gdy
+ * nie ma cofniętego ruchu, nie udało się alokować pamięci lub wskaźnik
+ * @p g ma wartość NULL.
+ */
+bool game_redo(game_t *g);
+
+/** @brief Podaje skrót stanu gry.
+ * Skrót jest sumą XOR 64-bitowych kluczy (gracz, pole) wszystkich zajętych
+ * pól (skrót Zobrista), więc nie zależy od kolejności ruchów, a każdy ruch
+ * i jego cofnięcie zmienia go w czasie stałym. Różne stany gry mają różne
+ * skróty z prawdopodobieństwem bliskim 1 - 2^-64 dla każdej pary stanów.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Skrót stanu gry lub zero, gdy wskaźnik @p g ma wartość NULL.
+ */
+uint64_t game_hash(game_t const *g);
+
+/**
+ * To jest deklaracja struktury tablicy transpozycji, która przechowuje
+ * wartości związane ze skrótami stanów gry (zob. @ref game_hash).
+ */
+typedef struct game_table game_table_t;
+
+/** @brief Tworzy tablicę transpozycji.
+ * Tablica ma stały rozmiar: @p entries zaokrąglone w górę do potęgi dwójki
+ * pozycji po 16 bajtów. Każdy skrót ma jedną pozycję, a nowa wartość
+ * zastępuje wartość innego skrótu o tej samej pozycji. Tablica może być
+ * jednocześnie używana przez wiele wątków bez blokad. Gdy nie udało się
+ * alokować pamięci, ustawia @p errno na @p ENOMEM.
+ * @param[in] entries – liczba pozycji, liczba dodatnia nie większa niż 2^58.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się alokować
+ * pamięci lub parametr jest niepoprawny.
+ */
+game_table_t* game_table_new(uint64_t entries);
+
+/** @brief Usuwa tablicę transpozycji.
+ * Nic nie robi, jeśli wskaźnik @p t ma wartość NULL.
+ * @param[in] t       – wskaźnik na tablicę transpozycji.
+ */
+void game_table_delete(game_table_t *t);
+
+/** @brief Zapamiętuje wartość związaną ze skrótem.
+ * @param[in,out] t   – wskaźnik na tablicę transpozycji,
+ * @param[in] hash    – skrót stanu gry,
+ * @param[in] value   – wartość.
+ */
+void game_table_store(game_table_t *t, uint64_t hash, uint64_t value);
+
+/** @brief Szuka wartości związanej ze skrótem.
+ * Wartość zapisywana w tym samym czasie przez inny wątek może nie zostać
+ * znaleziona. Wartość innego skrótu jest podawana tylko wtedy, gdy jej
+ * 64-bitowa suma kontrolna przypadkiem się zgadza, czyli z prawdopodobieństwem
+ * 2^-64.
+ * @param[in] t       – wskaźnik na tablicę transpozycji,
+ * @param[in] hash    – skrót stanu gry,
+ * @param[out] value  – wskaźnik, pod którym umieszczana jest wartość.
+ * @return Wartość @p true, jeśli wartość została znaleziona, a @p false
+ * w przeciwnym przypadku.
+ */
+bool game_table_find(game_table_t const *t, uint64_t hash, uint64_t *value);
+
+/** @brief Liczniki pracy silnika gry (zob. @ref game_stats).
+ */
+typedef struct game_stats {
+    uint64_t moves;          ///< Liczba prób ruchu funkcjami @ref game_move
+                             ///< i @ref game_move_batch.
+    uint64_t made_moves;     ///< Liczba wykonanych ruchów (także ponownie).
+    uint64_t new_areas;      ///< Liczba ruchów tworzących nowy obszar.
+    uint64_t merging_moves;  ///< Liczba ruchów łączących kilka obszarów.
+    uint64_t merged_areas;   ///< Liczba obszarów dołączonych do innych.
+    uint64_t areas_failures; ///< Liczba ruchów odrzuconych, bo gracz zajął
+                             ///< już maksymalną liczbę obszarów.
+    uint64_t find_steps;     ///< Liczba krawędzi lasu obszarów przebytych
+                             ///< przy szukaniu obszarów pól.
+    uint64_t longest_find;   ///< Najdłuższa ścieżka w lesie obszarów.
+    uint64_t compactions;    ///< Liczba przenumerowań obszarów.
+} game_stats_t;
+
+/** @brief Podaje liczniki pracy silnika gry.
+ * Liczniki są zliczane tylko wtedy, gdy silnik został skompilowany z flagą
+ * @p -DGAME_STATS; bez niej nie zajmują pamięci ani czasu, a funkcja ustawia
+ * @p errno na @p ENOTSUP. Kopia gry (zob. @ref game_clone) zaczyna od
+ * liczników równych zero.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] stats  – wskaźnik, pod którym umieszczane są liczniki.
+ * @return Wartość @p true, jeśli liczniki zostały podane, a @p false, gdy
+ * silnik nie zlicza liczników lub któryś ze wskaźników ma wartość NULL.
+ */
+bool game_stats(game_t const *g, game_stats_t *stats);
+
 #endif /* GAME_H */
 
@@ -0,0 +1,354 @@
+/** @file
+ * End-to-end benchmark of the engine.
+ *
+ * Plays seeded random games and scripted games on boards from 8 x 8 to
+ * 20000 x 20000 with 2 to 61 players and several limits of areas. Every
+ * move is followed by game_free_fields of its player, like in a real game,
+ * and every game ends with game_board. Every workload runs in its own
+ * process, so its peak resident set size and its allocations are counted
+ * separately. The results are written as JSON, one line per workload:
+ *
+ * workload, width, height, players, areas, games - the workload,
+ * moves, made          - the number of the tried and the legal moves,
+ * moves_per_s          - the tried moves per second of game_move,
+ * p50_ns, p99_ns, p999_ns - the percentiles of the time of game_move,
+ * free_fields_ns       - the mean time of game_free_fields,
+ * new_us, board_ms     - the mean time of game_new and game_board (null
+ *                        if the board is too large to be rendered),
+ * peak_rss_kb          - the peak resident set size of the process,
+ * allocations, mappings - the numbers of calls of malloc, calloc and
+ *                        realloc and of mmap,
+ * timer_ns             - the cost of reading the clock, which is included
+ *                        in the times of single calls.
+ *
+ * game_bench [<workload name>]
+ *     Runs all workloads or only those with the given name.
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+/**
+ * Funkcje clock_gettime, fork, getrusage i mmap są częścią standardu POSIX.
+ */
+#define _DEFAULT_SOURCE
+
+#include "game.h"
+#include "game_random.h"
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Number of the sub-buckets of every power of two in the histogram
+// of the times of the moves (as a power of two). The percentiles are
+// precise up to 1/16 of their value.
+#define HISTOGRAM_SUB_BITS 4
+
+// Number of the buckets of the histogram.
+#define HISTOGRAM_BUCKETS (64 << HISTOGRAM_SUB_BITS)
+
+// Maximal number of fields of the board rendered by game_board.
+#define MAX_RENDERED_FIELDS (1 << 24)
+
+/** @brief The kinds of the games:
+ * RANDOM       - the moves of random players on random fields,
+ * SNAKE        - the fields are taken row after row, left to right and
+ *                right to left in turn, and every row belongs to the next
+ *                player, so the areas are long and they touch other areas,
+ * CHECKERBOARD - the fields are taken row by row and the neighbour fields
+ *                belong to different players, so every field is an area
+ *                until the players run out of areas.
+ */
+typedef enum Kind {
+    RANDOM,
+    SNAKE,
+    CHECKERBOARD
+} kind_t;
+
+/** @brief A workload of the benchmark: games games of the kind with
+ * moves moves each, on the board width x height with the given players
+ * and areas.
+ */
+typedef struct Workload {
+    char const* name;
+    kind_t kind;
+    uint32_t width;
+    uint32_t height;
+    uint32_t players;
+    uint32_t areas;
+    uint64_t moves;
+    uint64_t games;
+} workload_t;
+
+static workload_t const WORKLOADS[] = {
+    {"random", RANDOM, 8, 8, 2, 1, 256, 20000},
+    {"random", RANDOM, 8, 8, 61, UINT32_MAX, 256, 20000},
+    {"random", RANDOM, 100, 100, 8, 10, 40000, 50},
+    {"random", RANDOM, 100, 100, 61, 100, 40000, 50},
+    {"random", RANDOM, 1000, 1000, 2, UINT32_MAX, 2000000, 1},
+    {"random", RANDOM, 1000, 1000, 61, 1, 2000000, 1},
+    {"random", RANDOM, 1000, 1000, 8, 1000, 2000000, 1},
+    {"random", RANDOM, 20000, 20000, 8, UINT32_MAX, 100000, 1},
+    {"snake", SNAKE, 1000, 1000, 2, UINT32_MAX, 1000000, 1},
+    {"snake", SNAKE, 20000, 20000, 61, 1000, 2000000, 1},
+    {"checkerboard", CHECKERBOARD, 1000, 1000, 2, UINT32_MAX, 1000000, 1},
+    {"checkerboard", CHECKERBOARD, 1000, 1000, 61, 100, 1000000, 1},
+};
+
+// Numbers of the calls of the allocation functions (see the makefile,
+// which links them with --wrap).
+static uint64_t allocations;
+static uint64_t mappings;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+void* __real_mmap(void* address, size_t length, int protection, int flags, int fd,
+                  off_t offset);
+
+void* __wrap_malloc(size_t size) {
+    allocations++;
+
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    allocations++;
+
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    allocations++;
+
+    return __real_realloc(pointer, size);
+}
+
+void* __wrap_mmap(void* address, size_t length, int protection, int flags, int fd,
+                  off_t offset) {
+    mappings++;
+
+    return __real_mmap(address, length, protection, flags, fd, offset);
+}
+
+// Returns the current time in nanoseconds.
+static uint64_t now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+}
+
+// Returns the bucket of the histogram of the value.
+static int histogram_bucket(uint64_t value) {
+    if (value < (1 << HISTOGRAM_SUB_BITS)) {
+        return (int)value;
+    }
+
+    int power = 63 - __builtin_clzll(value);
+    int shift = power - HISTOGRAM_SUB_BITS;
+
+    return (shift + 1) << HISTOGRAM_SUB_BITS |
+           (int)(value >> shift & ((1 << HISTOGRAM_SUB_BITS) - 1));
+}
+
+// Returns the smallest value of the bucket of the histogram.
+static uint64_t bucket_value(int bucket) {
+    if (bucket < (1 << HISTOGRAM_SUB_BITS)) {
+        return (uint64_t)bucket;
+    }
+
+    int shift = (bucket >> HISTOGRAM_SUB_BITS) - 1;
+    uint64_t mantissa = (uint64_t)(bucket & ((1 << HISTOGRAM_SUB_BITS) - 1));
+
+    return ((uint64_t)1 << HISTOGRAM_SUB_BITS | mantissa) << shift;
+}
+
+// Returns the value below which the given part of the values of the histogram are.
+static uint64_t percentile(uint64_t const* histogram, uint64_t count, double part) {
+    uint64_t below = 0;
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        below += histogram[i];
+
+        if ((double)below >= part * (double)count) {
+            return bucket_value(i);
+        }
+    }
+
+    return 0;
+}
+
+// Returns the i-th move of the scripted game of the kind on the board
+// width x height with the given number of players.
+static game_move_t scripted_move(kind_t kind, uint64_t i, uint32_t width, uint32_t height,
+                                 uint32_t players) {
+    game_move_t move;
+    uint64_t row = i / width % height;
+    uint64_t column = i % width;
+
+    move.y = (uint32_t)row;
+
+    if (kind == SNAKE) {
+        move.x = (uint32_t)(row % 2 == 0 ? column : width - 1 - column);
+        move.player = (uint32_t)(row % players) + 1;
+    }
+    else {
+        move.x = (uint32_t)column;
+        move.player = (uint32_t)((row + column) % players) + 1;
+    }
+
+    return move;
+}
+
+// Returns the cost in nanoseconds of reading the clock.
+static uint64_t timer_cost(void) {
+    uint64_t best = UINT64_MAX;
+
+    for (int i = 0; i < 1000; i++) {
+        uint64_t start = now();
+        uint64_t end = now();
+
+        if (end - start < best) {
+            best = end - start;
+        }
+    }
+
+    return best;
+}
+
+// Runs the workload and writes its results.
+static void run(workload_t const* w) {
+    static uint64_t histogram[HISTOGRAM_BUCKETS];
+    uint64_t timer = timer_cost();
+    uint64_t seed = 2023;
+    uint64_t made = 0;
+    uint64_t move_time = 0;
+    uint64_t free_fields_time = 0;
+    uint64_t new_time = 0;
+    uint64_t board_time = 0;
+    bool rendered = (uint64_t)w->width * w->height <= MAX_RENDERED_FIELDS;
+
+    allocations = 0;
+    mappings = 0;
+
+    for (uint64_t game = 0; game < w->games; game++) {
+        uint64_t start = now();
+        game_t* g = game_new(w->width, w->height, w->players, w->areas);
+
+        new_time += now() - start;
+
+        if (!g) {
+            fprintf(stderr, "Not enough memory.\n");
+            exit(1);
+        }
+
+        for (uint64_t i = 0; i < w->moves; i++) {
+            game_move_t move;
+
+            if (w->kind == RANDOM) {
+                move = game_random_move(&seed, w->players, w->width, w->height);
+            }
+            else {
+                move = scripted_move(w->kind, i, w->width, w->height, w->players);
+            }
+
+            uint64_t before = now();
+            bool result = game_move(g, move.player, move.x, move.y);
+            uint64_t moved = now();
+            uint64_t free_fields = game_free_fields(g, move.player);
+            uint64_t after = now();
+
+            made += result;
+            move_time += moved - before;
+            free_fields_time += after - moved;
+            histogram[histogram_bucket(moved - before)]++;
+
+            // The value is used, so the call is not removed.
+            __asm__ volatile("" : : "r"(free_fields));
+        }
+
+        if (rendered) {
+            start = now();
+
+            char* board = game_board(g);
+
+            board_time += now() - start;
+
+            if (!board) {
+                fprintf(stderr, "Not enough memory.\n");
+                exit(1);
+            }
+
+            free(board);
+        }
+
+        game_delete(g);
+    }
+
+    struct rusage usage;
+    uint64_t moves = w->moves * w->games;
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("{\"workload\":\"%s\",\"width\":%u,\"height\":%u,\"players\":%u,\"areas\":%u,"
+           "\"games\":%lu,\"moves\":%lu,\"made\":%lu,\"moves_per_s\":%.0f,"
+           "\"p50_ns\":%lu,\"p99_ns\":%lu,\"p999_ns\":%lu,\"free_fields_ns\":%.1f,"
+           "\"new_us\":%.1f,",
+           w->name, w->width, w->height, w->players, w->areas, w->games, moves, made,
+           (double)moves * 1e9 / (double)move_time, percentile(histogram, moves, 0.5),
+           percentile(histogram, moves, 0.99), percentile(histogram, moves, 0.999),
+           (double)free_fields_time / (double)moves, (double)new_time * 1e-3 / (double)w->games);
+
+    if (rendered) {
+        printf("\"board_ms\":%.3f,", (double)board_time * 1e-6 / (double)w->games);
+    }
+    else {
+        printf("\"board_ms\":null,");
+    }
+
+    printf("\"peak_rss_kb\":%ld,\"allocations\":%lu,\"mappings\":%lu,\"timer_ns\":%lu}\n",
+           usage.ru_maxrss, allocations, mappings, timer);
+    fflush(stdout);
+}
+
+int main(int argc, char const* argv[]) {
+    int failed = 0;
+
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [<workload name>]\n", argv[0]);
+
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(WORKLOADS) / sizeof(WORKLOADS[0]); i++) {
+        if (argc == 2 && strcmp(argv[1], WORKLOADS[i].name) != 0) {
+            continue;
+        }
+
+        // Every workload has its own process, so its peak resident set size
+        // does not include the memory of the previous workloads.
+        fflush(stdout);
+
+        pid_t child = fork();
+        int status;
+
+        if (child == 0) {
+            run(&WORKLOADS[i]);
+            exit(0);
+        }
+
+        if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != 0) {
+            failed = 1;
+        }
+    }
+
+    return failed;
+}
@@ -0,0 +1,112 @@
+/** @file
+ * Benchmark of the game board rendering.
+ *
+ * Fills boards of several sizes with figures of 61 players and measures
+ * how many bytes per second are rendered by game_board, which allocates
+ * a new buffer every time, and by game_board_into, which writes into
+ * the same buffer every time.
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+/**
+ * Funkcja clock_gettime jest częścią standardu POSIX.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "game.h"
+#include "game_random.h"
+#include <time.h>
+
+// Number of the measured board sizes.
+#define SIZES 4
+
+// Minimal number of bytes rendered by each function for one board size.
+#define BYTES_PER_MEASUREMENT (1ULL << 30)
+
+// Returns the current time in seconds.
+static double now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+// Creates the game with the given board size. Every field is taken
+// by one of 61 players or left empty.
+static game_t* filled_game(uint32_t width, uint32_t height) {
+    game_t* g = game_new(width, height, 61, UINT32_MAX);
+    uint64_t seed = 2023;
+
+    if (!g) {
+        return NULL;
+    }
+
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint32_t player = game_random_number(&seed, 62);
+
+            if (player != 0) {
+                game_move(g, player, x, y);
+            }
+        }
+    }
+
+    return g;
+}
+
+int main() {
+    uint32_t const widths[SIZES] = {8, 64, 1000, 4000};
+    uint32_t const heights[SIZES] = {8, 64, 1000, 4000};
+
+    printf("%-12s %16s %16s\n", "board", "game_board B/s", "board_into B/s");
+
+    for (int i = 0; i < SIZES; i++) {
+        game_t* g = filled_game(widths[i], heights[i]);
+        uint64_t size = game_board_into(g, NULL, 0);
+        char* buffer = malloc(size);
+        uint64_t calls = BYTES_PER_MEASUREMENT / size + 1;
+        uint64_t checksum = 0;
+
+        if (!g || !buffer) {
+            fprintf(stderr, "Not enough memory.\n");
+
+            return 1;
+        }
+
+        double start = now();
+
+        for (uint64_t j = 0; j < calls; j++) {
+            char* board = game_board(g);
+
+            checksum += (unsigned char)board[j % size];
+            free(board);
+        }
+
+        double middle = now();
+
+        for (uint64_t j = 0; j < calls; j++) {
+            game_board_into(g, buffer, size);
+            checksum += (unsigned char)buffer[j % size];
+        }
+
+        double end = now();
+
+        printf("%5ux%-6u %16.3e %16.3e\n", widths[i], heights[i],
+               (double)(calls * size) / (middle - start),
+               (double)(calls * size) / (end - middle));
+
+        if (checksum == 0) {
+            printf("checksum 0\n");
+        }
+
+        free(buffer);
+        game_delete(g);
+    }
+
+    return 0;
+}
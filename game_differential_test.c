@@ -0,0 +1,438 @@
+/** @file
+ * Differential test of the game engine against a reference model.
+ *
+ * The reference model implements the rules of game.h in the simplest way:
+ * it keeps only the owners of the fields and counts the areas and the free
+ * fields from scratch by searching the whole board. Random sequences of
+ * moves (also with wrong players and coordinates) are played by both
+ * engines on small boards and after every move the results of game_move,
+ * game_busy_fields and game_free_fields of all players, game_next_player
+ * of the player of the move, game_any_player_can_move and game_board are
+ * compared. In the middle of every sequence the game is replaced by its
+ * clone, so also the boards shared by the cloned games are checked.
+ * Some of the games have more players than the one character symbols
+ * and the moves are made by players whose fields have the same owner
+ * tags in the engine (1, 256, ...), so the boards with the numbers
+ * of the players and the areas kept by the player numbers are checked.
+ * The failing sequences are shortened by removing the moves which are
+ * not needed for the failure and the shortest of them is written.
+ *
+ * game_differential_test [<number of sequences> [<seed>]]
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+#include "game.h"
+#include "game_random.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Default number of played sequences.
+#define DEFAULT_SEQUENCES 20000
+
+// Maximal length of the side of the board.
+#define MAX_SIDE 8
+
+// Maximal number of players and areas.
+#define MAX_TEST_PLAYERS 5
+#define MAX_TEST_AREAS 4
+
+// Number of players of the games with many players.
+#define MANY_PLAYERS 300
+
+// Players checked in the games with many players. The fields of the players
+// 1, 256 and 2, 257 have the same owner tags in the engine.
+static uint32_t const MANY_CHECKED[] = {0, 1, 2, 255, 256, 257, 300, 301};
+
+#define MANY_CHECKED_COUNT (sizeof(MANY_CHECKED) / sizeof(MANY_CHECKED[0]))
+
+// Maximal length of the text of a field: the number of a player and a space.
+#define MAX_FIELD_TEXT 4
+
+// Maximal number of moves of a sequence.
+#define MAX_MOVES (3 * MAX_SIDE * MAX_SIDE)
+
+/** @brief A sequence of moves played on the board width x height
+ * with the given players and areas. The game is cloned before
+ * the move clone_at.
+ */
+typedef struct Sequence {
+    uint32_t width;
+    uint32_t height;
+    uint32_t players;
+    uint32_t areas;
+    uint32_t length;
+    uint32_t clone_at;
+    game_move_t moves[MAX_MOVES];
+} sequence_t;
+
+/** @brief The reference game: owners[y * width + x] is the player number
+ * of the field (x,y) or zero if it is empty.
+ */
+typedef struct Reference {
+    uint32_t width;
+    uint32_t height;
+    uint32_t players;
+    uint32_t areas;
+    uint32_t owners[MAX_SIDE * MAX_SIDE];
+} reference_t;
+
+// Returns the owner of the field (x,y) or zero if it is empty or outside
+// of the board.
+static uint32_t reference_owner(reference_t const* r, int64_t x, int64_t y) {
+    if (x < 0 || y < 0 || x >= r->width || y >= r->height) {
+        return 0;
+    }
+
+    return r->owners[y * r->width + x];
+}
+
+// Returns true if the field (x,y) is empty and it has a neighbour of the player.
+static bool reference_touches(reference_t const* r, uint32_t player, int64_t x, int64_t y) {
+    return reference_owner(r, x, y) == 0 &&
+           (reference_owner(r, x + 1, y) == player || reference_owner(r, x - 1, y) == player ||
+            reference_owner(r, x, y + 1) == player || reference_owner(r, x, y - 1) == player);
+}
+
+// Returns the number of the areas of the player found by searching the board.
+static uint32_t reference_areas(reference_t const* r, uint32_t player) {
+    bool visited[MAX_SIDE * MAX_SIDE] = {false};
+    uint32_t stack[MAX_SIDE * MAX_SIDE];
+    uint32_t areas = 0;
+
+    for (uint32_t i = 0; i < r->width * r->height; i++) {
+        if (r->owners[i] != player || visited[i]) {
+            continue;
+        }
+
+        uint32_t length = 0;
+
+        areas++;
+        visited[i] = true;
+        stack[length++] = i;
+
+        while (length > 0) {
+            uint32_t field = stack[--length];
+            int64_t x = field % r->width;
+            int64_t y = field / r->width;
+            int64_t const dx[4] = {1, -1, 0, 0};
+            int64_t const dy[4] = {0, 0, 1, -1};
+
+            for (int k = 0; k < 4; k++) {
+                if (reference_owner(r, x + dx[k], y + dy[k]) == player) {
+                    uint32_t next = (uint32_t)((y + dy[k]) * r->width + x + dx[k]);
+
+                    if (!visited[next]) {
+                        visited[next] = true;
+                        stack[length++] = next;
+                    }
+                }
+            }
+        }
+    }
+
+    return areas;
+}
+
+static bool reference_move(reference_t* r, uint32_t player, uint32_t x, uint32_t y) {
+    if (player == 0 || player > r->players || x >= r->width || y >= r->height ||
+        reference_owner(r, x, y) != 0) {
+        return false;
+    }
+
+    if (!reference_touches(r, player, x, y) && reference_areas(r, player) >= r->areas) {
+        return false;
+    }
+
+    r->owners[y * r->width + x] = player;
+
+    return true;
+}
+
+static uint64_t reference_busy_fields(reference_t const* r, uint32_t player) {
+    uint64_t busy = 0;
+
+    for (uint32_t i = 0; player != 0 && i < r->width * r->height; i++) {
+        busy += r->owners[i] == player;
+    }
+
+    return busy;
+}
+
+static uint64_t reference_free_fields(reference_t const* r, uint32_t player) {
+    if (player == 0 || player > r->players) {
+        return 0;
+    }
+
+    bool all_areas = reference_areas(r, player) >= r->areas;
+    uint64_t free_fields = 0;
+
+    for (uint32_t y = 0; y < r->height; y++) {
+        for (uint32_t x = 0; x < r->width; x++) {
+            free_fields += all_areas ? reference_touches(r, player, x, y)
+                                     : reference_owner(r, x, y) == 0;
+        }
+    }
+
+    return free_fields;
+}
+
+// Returns the next player after the given one who can move or zero if none
+// of the players can move, like game_next_player does.
+static uint32_t reference_next_player(reference_t const* r, uint32_t player) {
+    uint32_t start = player <= r->players ? player : 0;
+
+    for (uint32_t i = 1; i <= r->players; i++) {
+        uint32_t next = (start + i - 1) % r->players + 1;
+
+        if (reference_free_fields(r, next) > 0) {
+            return next;
+        }
+    }
+
+    return 0;
+}
+
+// Writes the board of the reference game like game_board does.
+static void reference_board(reference_t const* r, char* board) {
+    char const symbols[] = ".123456789";
+
+    for (uint32_t row = 0; row < r->height; row++) {
+        for (uint32_t x = 0; x < r->width; x++) {
+            uint32_t owner = reference_owner(r, x, r->height - 1 - row);
+
+            if (r->players < MANY_PLAYERS) {
+                *board++ = symbols[owner];
+            }
+            else if (owner == 0) {
+                board += sprintf(board, "  .%c", x + 1 == r->width ? '\n' : ' ');
+            }
+            else {
+                board += sprintf(board, "%3u%c", owner, x + 1 == r->width ? '\n' : ' ');
+            }
+        }
+
+        if (r->players < MANY_PLAYERS) {
+            *board++ = '\n';
+        }
+    }
+
+    *board = '\0';
+}
+
+// Returns the number of the players checked after every move.
+static uint32_t checked_count(sequence_t const* s) {
+    return s->players < MANY_PLAYERS ? s->players + 2 : (uint32_t)MANY_CHECKED_COUNT;
+}
+
+// Returns the i-th player checked after every move: all players and the wrong
+// ones next to them or, in the games with many players, the players from
+// MANY_CHECKED.
+static uint32_t checked_player(sequence_t const* s, uint32_t i) {
+    return s->players < MANY_PLAYERS ? i : MANY_CHECKED[i];
+}
+
+// Returns a random sequence of moves. The players and the coordinates are
+// sometimes wrong and the moves are often next to the previous ones,
+// so the areas are joined.
+static sequence_t random_sequence(uint64_t* seed) {
+    sequence_t s;
+
+    s.width = game_random_number(seed, MAX_SIDE) + 1;
+    s.height = game_random_number(seed, MAX_SIDE) + 1;
+    s.players = game_random_number(seed, 8) == 0 ? MANY_PLAYERS
+                                                 : game_random_number(seed, MAX_TEST_PLAYERS) + 1;
+    s.areas = game_random_number(seed, MAX_TEST_AREAS) + 1;
+    s.length = game_random_number(seed, MAX_MOVES) + 1;
+    s.clone_at = game_random_number(seed, s.length);
+
+    for (uint32_t i = 0; i < s.length; i++) {
+        game_move_t* move = &s.moves[i];
+
+        move->player = checked_player(&s, game_random_number(seed, checked_count(&s)));
+        move->x = game_random_number(seed, s.width + 1);
+        move->y = game_random_number(seed, s.height + 1);
+
+        if (i > 0 && game_random_number(seed, 2) == 0) {
+            int const direction = (int)game_random_number(seed, 4);
+
+            move->player = s.moves[i - 1].player;
+            move->x = s.moves[i - 1].x + (direction == 0) - (direction == 1);
+            move->y = s.moves[i - 1].y + (direction == 2) - (direction == 3);
+        }
+    }
+
+    return s;
+}
+
+// Plays the sequence on both engines. Returns the number of the first move
+// after which the engines differ or the length of the sequence if they
+// do not differ. If message is not NULL, the difference is written to it.
+static uint32_t play(sequence_t const* s, char* message, size_t message_length) {
+    reference_t r = {.width = s->width, .height = s->height, .players = s->players,
+                     .areas = s->areas};
+    game_t* g = game_new(s->width, s->height, s->players, s->areas);
+    char expected[MAX_FIELD_TEXT * MAX_SIDE * MAX_SIDE + 1];
+    uint32_t step;
+
+    if (!g) {
+        fprintf(stderr, "Not enough memory.\n");
+        exit(1);
+    }
+
+    for (step = 0; step < s->length; step++) {
+        game_move_t const* move = &s->moves[step];
+
+        if (step == s->clone_at) {
+            game_t* clone = game_clone(g);
+
+            if (!clone) {
+                fprintf(stderr, "Not enough memory.\n");
+                exit(1);
+            }
+
+            game_delete(g);
+            g = clone;
+        }
+
+        bool result = game_move(g, move->player, move->x, move->y);
+
+        if (result != reference_move(&r, move->player, move->x, move->y)) {
+            snprintf(message, message_length, "game_move returned %s", result ? "true" : "false");
+            break;
+        }
+
+        bool same = true;
+
+        for (uint32_t i = 0; same && i < checked_count(s); i++) {
+            uint32_t player = checked_player(s, i);
+            uint64_t busy = game_busy_fields(g, player);
+            uint64_t free_fields = game_free_fields(g, player);
+
+            if (busy != reference_busy_fields(&r, player)) {
+                snprintf(message, message_length, "game_busy_fields(%u) returned %lu",
+                         player, busy);
+                same = false;
+            }
+            else if (free_fields != reference_free_fields(&r, player)) {
+                snprintf(message, message_length, "game_free_fields(%u) returned %lu",
+                         player, free_fields);
+                same = false;
+            }
+        }
+
+        if (!same) {
+            break;
+        }
+
+        uint32_t next = game_next_player(g, move->player);
+
+        if (next != reference_next_player(&r, move->player)) {
+            snprintf(message, message_length, "game_next_player(%u) returned %u", move->player,
+                     next);
+            break;
+        }
+
+        if (game_any_player_can_move(g) != (next != 0)) {
+            snprintf(message, message_length, "game_any_player_can_move returned %s",
+                     next != 0 ? "false" : "true");
+            break;
+        }
+
+        char* board = game_board(g);
+
+        reference_board(&r, expected);
+
+        if (!board || strcmp(board, expected) != 0) {
+            snprintf(message, message_length, "game_board returned\n%s", board ? board : "NULL");
+            free(board);
+            break;
+        }
+
+        free(board);
+    }
+
+    game_delete(g);
+
+    return step;
+}
+
+// Shortens the failing sequence: cuts it after the first difference and
+// removes every move which is not needed for a difference.
+static void shorten(sequence_t* s, char* message, size_t message_length) {
+    s->length = play(s, message, message_length) + 1;
+
+    for (uint32_t i = s->length; i-- > 0;) {
+        if (i >= s->length) {
+            continue;
+        }
+
+        sequence_t shorter = *s;
+
+        memmove(&shorter.moves[i], &shorter.moves[i + 1],
+                (shorter.length - i - 1) * sizeof(game_move_t));
+        shorter.length--;
+        shorter.clone_at -= shorter.clone_at > i;
+
+        uint32_t step = play(&shorter, message, message_length);
+
+        if (step < shorter.length) {
+            shorter.length = step + 1;
+            *s = shorter;
+        }
+    }
+
+    play(s, message, message_length);
+}
+
+int main(int argc, char const* argv[]) {
+    uint64_t sequences = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_SEQUENCES;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 2023;
+    uint64_t failures = 0;
+    sequence_t shortest = {.length = 0};
+    char message[256] = "";
+    char shortest_message[256] = "";
+
+    for (uint64_t i = 0; i < sequences; i++) {
+        sequence_t s = random_sequence(&seed);
+
+        if (play(&s, message, sizeof(message)) == s.length) {
+            continue;
+        }
+
+        failures++;
+        shorten(&s, message, sizeof(message));
+
+        if (shortest.length == 0 || s.length < shortest.length) {
+            shortest = s;
+            memcpy(shortest_message, message, sizeof(message));
+        }
+    }
+
+    if (failures == 0) {
+        printf("%lu sequences: no differences\n", sequences);
+
+        return 0;
+    }
+
+    printf("%lu of %lu sequences differ, the shortest one:\n", failures, sequences);
+    printf("game_new(%u, %u, %u, %u)\n", shortest.width, shortest.height, shortest.players,
+           shortest.areas);
+
+    for (uint32_t i = 0; i < shortest.length; i++) {
+        if (i == shortest.clone_at) {
+            printf("game_clone\n");
+        }
+
+        printf("game_move(%u, %u, %u)\n", shortest.moves[i].player, shortest.moves[i].x,
+               shortest.moves[i].y);
+    }
+
+    printf("%s\n", shortest_message);
+
+    return 1;
+}
@@ -11,8 +11,15 @@
 #undef NDEBUG
 #endif
 
+/**
+ * Funkcja fileno jest częścią standardu POSIX.
+ */
+#define _POSIX_C_SOURCE 200809L
+
 #include "game.h"
+#include "game_random.h"
 #include <assert.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,6 +46,972 @@ static const char test[] =
         "..15...\n"
         "1111111\n";
 
+/** @brief Wykonuje pseudolosowe ruchy.
+ * Wykonuje na grze @p g @p moves ruchów wyznaczonych przez ziarno @p seed.
+ */
+static void play_random_moves(game_t *g, uint64_t seed, uint32_t moves) {
+    for (uint32_t i = 0; i < moves; i++) {
+        game_move_t move = game_random_move(&seed, game_players(g), game_board_width(g),
+                                            game_board_height(g));
+
+        game_move(g, move.player, move.x, move.y);
+    }
+}
+
+/** @brief Wykonuje ten sam ruch w obu grach.
+ * Sprawdza, czy ruch @p move ma w grach @p g i @p h ten sam wynik i czy
+ * gracz ma potem w obu grach tyle samo zajętych i wolnych pól.
+ */
+static void assert_same_move(game_t *g, game_t *h, game_move_t move) {
+    assert(game_move(g, move.player, move.x, move.y) ==
+           game_move(h, move.player, move.x, move.y));
+    assert(game_busy_fields(g, move.player) == game_busy_fields(h, move.player));
+    assert(game_free_fields(g, move.player) == game_free_fields(h, move.player));
+}
+
+/** @brief Sprawdza, czy gry mają ten sam stan.
+ * Porównuje liczby zajętych i wolnych pól każdego gracza oraz plansze
+ * gier @p g i @p h.
+ */
+static void assert_same_game(game_t *g, game_t *h) {
+    for (uint32_t player = 1; player <= game_players(g); player++) {
+        assert(game_busy_fields(g, player) == game_busy_fields(h, player));
+        assert(game_free_fields(g, player) == game_free_fields(h, player));
+    }
+
+    char *p = game_board(g);
+    char *q = game_board(h);
+    assert(p && q);
+    assert(strcmp(p, q) == 0);
+    free(p);
+    free(q);
+}
+
+/** @brief Testuje funkcję game_move_batch.
+ * Wykonuje te same pseudolosowe ruchy za pomocą funkcji game_move
+ * i game_move_batch na dwóch grach i porównuje ich wyniki.
+ */
+static void test_move_batch(void) {
+    game_t *single = game_new(31, 17, 5, 3);
+    game_t *batch = game_new(31, 17, 5, 3);
+    game_move_t moves[1000];
+    bool results[1000];
+    uint64_t seed = 12345;
+    uint64_t made_moves = 0;
+
+    assert(single != NULL && batch != NULL);
+
+    // Gracze 0 i 6 oraz pola poza planszą dają błędne ruchy.
+    for (uint32_t i = 0; i < 1000; i++) {
+        moves[i] = game_random_move(&seed, 7, 33, 19);
+        moves[i].player %= 7;
+    }
+
+    assert(game_move_batch(batch, moves, 1000, results) > 0);
+
+    for (uint32_t i = 0; i < 1000; i++) {
+        bool result = game_move(single, moves[i].player, moves[i].x, moves[i].y);
+        assert(result == results[i]);
+        made_moves += result;
+    }
+
+    assert_same_game(single, batch);
+
+    assert(game_move_batch(NULL, moves, 2, results) == 0);
+    assert(!results[0] && !results[1]);
+    assert(made_moves > 0);
+
+    game_delete(single);
+    game_delete(batch);
+}
+
+/** @brief Testuje funkcję game_legal_moves.
+ * Po każdym pseudolosowym ruchu sprawdza, czy dla każdego gracza podane
+ * pola są różne, wolne i jest ich tyle, ile podaje funkcja game_free_fields,
+ * a gdy nie są to wszystkie wolne pola, to czy sąsiadują z pionkiem gracza.
+ */
+static void test_legal_moves(void) {
+    uint32_t const width = 23, height = 13, players = 4;
+    game_t *g = game_new(width, height, players, 2);
+    game_field_t fields[23 * 13];
+    bool seen[23 * 13];
+    uint64_t seed = 777;
+
+    assert(g != NULL);
+
+    for (uint32_t i = 0; i < 2000; i++) {
+        game_move_t move = game_random_move(&seed, players, width, height);
+
+        game_move(g, move.player, move.x, move.y);
+
+        char *b = game_board(g);
+        uint64_t empty = 0;
+        assert(b != NULL);
+
+        for (char const *c = b; *c; c++) {
+            empty += (*c == '.');
+        }
+
+        for (uint32_t player = 1; player <= players; player++) {
+            uint64_t count = game_legal_moves(g, player, fields, width * height);
+            char symbol = game_player(g, player);
+
+            assert(count == game_free_fields(g, player));
+            assert(game_legal_moves(g, player, NULL, 0) == count);
+            memset(seen, 0, sizeof(seen));
+
+            for (uint64_t j = 0; j < count; j++) {
+                uint32_t x = fields[j].x, y = fields[j].y;
+                assert(x < width && y < height && !seen[y * width + x]);
+                seen[y * width + x] = true;
+
+                // Wiersz y jest w napisie na pozycji height - 1 - y.
+                char const *row = b + (height - 1 - y) * (width + 1);
+                assert(row[x] == '.');
+
+                if (count < empty) {
+                    bool touches = (x > 0 && row[x - 1] == symbol) ||
+                                   (x + 1 < width && row[x + 1] == symbol) ||
+                                   (y > 0 && row[width + 1 + x] == symbol) ||
+                                   (y + 1 < height && (row - (width + 1))[x] == symbol);
+                    assert(touches);
+                }
+            }
+
+            game_legal_moves_iterator_t it;
+            game_field_t field;
+            uint64_t iterated = 0;
+
+            game_legal_moves_begin(g, player, &it);
+            while (game_legal_moves_next(&it, &field)) {
+                assert(field.x == fields[iterated].x && field.y == fields[iterated].y);
+                iterated++;
+            }
+            assert(iterated == count);
+        }
+
+        free(b);
+    }
+
+    assert(game_legal_moves(g, 0, fields, 1) == 0);
+    assert(game_legal_moves(NULL, 1, fields, 1) == 0);
+
+    game_delete(g);
+}
+
+/** @brief Testuje funkcję game_frontier.
+ * Wykonuje te same pseudolosowe ruchy na dwóch grach, z których tylko jedna
+ * ma włączone w trakcie gry mapy bitowe, i porównuje podawane pola.
+ */
+static void test_frontier(void) {
+    uint32_t const width = 130, height = 9, players = 61;
+    game_t *bits = game_new(width, height, players, 3);
+    game_t *plain = game_new(width, height, players, 3);
+    game_field_t fields[130 * 9];
+    game_field_t plain_fields[130 * 9];
+    bool seen[130 * 9];
+    uint64_t seed = 4242;
+
+    assert(bits != NULL && plain != NULL);
+
+    for (uint32_t i = 0; i < 3000; i++) {
+        assert_same_move(bits, plain, game_random_move(&seed, players, width, height));
+
+        if (i == 500) {
+            assert(game_bitboards_enable(bits));
+        }
+        if (i < 500 || i % 100 != 0) {
+            continue;
+        }
+
+        for (uint32_t player = 1; player <= players; player++) {
+            uint64_t count = game_frontier(bits, player, fields, width * height);
+
+            assert(count == game_frontier(plain, player, plain_fields, width * height));
+            assert(count == game_frontier(bits, player, NULL, 0));
+            memset(seen, 0, sizeof(seen));
+
+            for (uint64_t j = 0; j < count; j++) {
+                seen[plain_fields[j].y * width + plain_fields[j].x] = true;
+            }
+            for (uint64_t j = 0; j < count; j++) {
+                assert(seen[fields[j].y * width + fields[j].x]);
+                assert(j == 0 || fields[j - 1].y < fields[j].y ||
+                       (fields[j - 1].y == fields[j].y && fields[j - 1].x < fields[j].x));
+            }
+        }
+    }
+
+    assert(game_frontier(bits, 0, fields, 1) == 0);
+    assert(!game_bitboards_enable(NULL));
+
+    game_delete(bits);
+    game_delete(plain);
+}
+
+/** @brief Testuje funkcję game_board_into.
+ * Sprawdza, czy napis w buforze jest taki sam jak napis z funkcji
+ * game_board i czy za krótki bufor nie jest zmieniany.
+ */
+static void test_board_into(void) {
+    game_t *g = game_new(70, 3, 61, 61);
+    char buffer[71 * 3 + 1];
+
+    assert(g != NULL);
+
+    for (uint32_t i = 0; i < 70 * 3; i++) {
+        assert(game_move(g, i % 61 + 1, i % 70, i / 70));
+    }
+
+    char *board = game_board(g);
+    assert(board != NULL);
+
+    memset(buffer, 'x', sizeof(buffer));
+    assert(game_board_into(g, buffer, sizeof(buffer) - 1) == sizeof(buffer));
+    assert(buffer[0] == 'x' && buffer[sizeof(buffer) - 1] == 'x');
+    assert(game_board_into(g, buffer, sizeof(buffer)) == sizeof(buffer));
+    assert(strcmp(board, buffer) == 0);
+    assert(game_board_into(NULL, buffer, sizeof(buffer)) == 0);
+
+    free(board);
+    game_delete(g);
+}
+
+/** @brief Testuje funkcję game_board_write.
+ * Zapisuje planszę do pliku tymczasowego i porównuje jego zawartość
+ * z napisem z funkcji game_board. Duża plansza jest zapisywana w kilku
+ * kawałkach, których granice nie pokrywają się z końcami wierszy.
+ */
+static void test_board_write(uint32_t width, uint32_t height) {
+    game_t *g = game_new(width, height, 61, 7);
+
+    assert(g != NULL);
+    play_random_moves(g, 99, width * height / 2);
+
+    char *board = game_board(g);
+    size_t length = strlen(board);
+    char *written = malloc(length + 1);
+    FILE *file = tmpfile();
+
+    assert(board && written && file);
+    assert(game_board_write(g, fileno(file)));
+    rewind(file);
+    assert(fread(written, 1, length + 1, file) == length);
+    assert(memcmp(board, written, length) == 0);
+    assert(!game_board_write(NULL, fileno(file)));
+
+    fclose(file);
+    free(written);
+    free(board);
+    game_delete(g);
+}
+
+/** @brief Testuje rzadką planszę.
+ * Wykonuje te same pseudolosowe ruchy na zwykłej i rzadkiej planszy
+ * i porównuje ich wyniki, a potem gra na planszy o największym
+ * możliwym rozmiarze.
+ */
+static void test_sparse_board(void) {
+    game_t *dense = game_new(100, 70, 9, 5);
+    game_t *sparse = game_new_sparse(100, 70, 9, 5);
+    uint64_t seed = 31337;
+
+    assert(dense != NULL && sparse != NULL);
+
+    // Gracz 10 i pola poza planszą dają błędne ruchy.
+    for (uint32_t i = 0; i < 20000; i++) {
+        assert_same_move(dense, sparse, game_random_move(&seed, 10, 101, 71));
+    }
+
+    assert_same_game(dense, sparse);
+    assert(!game_bitboards_enable(sparse));
+
+    game_delete(dense);
+    game_delete(sparse);
+
+    game_t *g = game_new(UINT32_MAX, UINT32_MAX, 2, 2);
+    uint64_t fields = (uint64_t)UINT32_MAX * UINT32_MAX;
+    game_field_t frontier[5];
+
+    assert(g != NULL);
+    assert(game_free_fields(g, 1) == fields);
+    assert(game_move(g, 1, 0, 0));
+    assert(game_move(g, 1, UINT32_MAX - 1, UINT32_MAX - 1));
+    assert(!game_move(g, 1, 1u << 31, 1u << 31));
+    assert(game_move(g, 1, 1, 0));
+    assert(game_move(g, 2, 1u << 31, 1u << 31));
+    assert(game_busy_fields(g, 1) == 3);
+    assert(game_free_fields(g, 1) == 5);
+    assert(game_legal_moves(g, 1, frontier, 5) == 5);
+    assert(game_free_fields(g, 2) == fields - 4);
+    assert(game_frontier(g, 2, frontier, 4) == 4);
+
+    game_delete(g);
+}
+
+/** @brief Testuje funkcje game_save i game_load.
+ * Zapisuje grę do pliku tymczasowego, odtwarza ją i sprawdza, czy dalsze
+ * pseudolosowe ruchy dają w obu grach takie same wyniki.
+ */
+static void test_save_load(bool sparse) {
+    game_t *g = sparse ? game_new_sparse(90, 50, 7, 3) : game_new(90, 50, 7, 3);
+
+    assert(g != NULL);
+    play_random_moves(g, 5, 10000);
+
+    FILE *file = tmpfile();
+    assert(file != NULL);
+    assert(game_save(g, fileno(file)));
+
+    game_t *loaded = game_load(fileno(file));
+    assert(loaded != NULL);
+
+    uint64_t seed = 6;
+
+    for (uint32_t i = 0; i < 10000; i++) {
+        assert_same_move(g, loaded, game_random_move(&seed, 7, 90, 50));
+    }
+
+    assert_same_game(g, loaded);
+    game_delete(loaded);
+
+    // Plik z uszkodzonym nagłówkiem nie jest wczytywany.
+    rewind(file);
+    assert(fputc('X', file) == 'X');
+    assert(fflush(file) == 0);
+    assert(game_load(fileno(file)) == NULL);
+    assert(errno == EINVAL);
+    assert(!game_save(NULL, fileno(file)));
+
+    fclose(file);
+    game_delete(g);
+}
+
+/** @brief Wczytuje grę z zapisu w pamięci.
+ * Zapisuje dane @p data o długości @p length do tymczasowego pliku
+ * i wczytuje z niego grę funkcją game_load.
+ * @return Wynik funkcji game_load.
+ */
+static game_t *load_saved(uint8_t const *data, size_t length) {
+    FILE *file = tmpfile();
+
+    assert(file != NULL);
+    assert(fwrite(data, 1, length, file) == length);
+    assert(fflush(file) == 0);
+    errno = 0;
+
+    game_t *g = game_load(fileno(file));
+
+    fclose(file);
+
+    return g;
+}
+
+/** @brief Sprawdza, że zapis gry w pamięci jest odrzucany jako niepoprawny.
+ */
+static void assert_rejected(uint8_t const *data, size_t length) {
+    assert(load_saved(data, length) == NULL);
+    assert(errno == EINVAL);
+}
+
+/** @brief Zapisuje grę i czyta cały zapis do pamięci.
+ * @param[in] g        – wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] length  – wskaźnik, pod którym umieszczana jest długość zapisu.
+ * @return Wskaźnik na zaalokowaną tablicę z zapisem gry.
+ */
+static uint8_t *saved_game(game_t const *g, size_t *length) {
+    FILE *file = tmpfile();
+
+    assert(file != NULL);
+    assert(game_save(g, fileno(file)));
+    assert(fseek(file, 0, SEEK_END) == 0);
+    *length = (size_t)ftell(file);
+
+    uint8_t *data = malloc(*length);
+
+    assert(data != NULL);
+    rewind(file);
+    assert(fread(data, 1, *length, file) == *length);
+    fclose(file);
+
+    return data;
+}
+
+/** @brief Testuje wczytywanie zapisu gry z uszkodzoną treścią.
+ * Zmienia w poprawnym zapisie planszę, obszary, tablicę graczy i brzegi
+ * graczy, nie ruszając nagłówka, i sprawdza, że funkcja game_load odrzuca
+ * każdy taki plik.
+ */
+static void test_load_corrupted(void) {
+    game_t *g = game_new(10, 10, 3, 2);
+
+    assert(g != NULL);
+    assert(game_move(g, 1, 0, 0));
+    assert(game_move(g, 2, 5, 5));
+
+    size_t length;
+    uint8_t *data = saved_game(g, &length);
+    uint8_t *copy = malloc(length);
+    assert(copy != NULL);
+
+    // Położenia części zapisu w nagłówku (zob. game_save).
+    uint64_t next_area, players, areas, frontier, owners, colors;
+    memcpy(&next_area, data + 40, sizeof(uint64_t));
+    memcpy(&players, data + 80, sizeof(uint64_t));
+    memcpy(&areas, data + 88, sizeof(uint64_t));
+    memcpy(&frontier, data + 96, sizeof(uint64_t));
+    memcpy(&owners, data + 104, sizeof(uint64_t));
+    memcpy(&colors, data + 112, sizeof(uint64_t));
+
+    // Plansza ma obrzeże szerokości 2, a wiersz ma 12 pól.
+    uint64_t taken = 2 * 12 + 0;
+    uint64_t empty = (9 + 2) * 12 + 9;
+    uint32_t const wrong_area[] = {0, (uint32_t)next_area};
+    uint32_t const cycle[] = {2, 1};
+    uint32_t const outside[] = {10, 0};
+    uint32_t const one = 1;
+
+    memcpy(copy, data, length);
+    game_t *loaded = load_saved(copy, length);
+    assert(loaded != NULL);
+    game_delete(loaded);
+
+    // Właściciel pola jest większy od liczby graczy.
+    copy[owners + taken] = 200;
+    assert_rejected(copy, length);
+    memcpy(copy, data, length);
+
+    // Obrzeże planszy nie jest puste.
+    copy[owners] = 1;
+    assert_rejected(copy, length);
+    memcpy(copy, data, length);
+
+    // Zajęte pole nie ma obszaru albo ma obszar spoza zakresu.
+    for (size_t i = 0; i < 2; i++) {
+        memcpy(copy + colors + taken * sizeof(uint32_t), &wrong_area[i], sizeof(uint32_t));
+        assert_rejected(copy, length);
+        memcpy(copy, data, length);
+    }
+
+    // Puste pole ma obszar.
+    memcpy(copy + colors + empty * sizeof(uint32_t), &one, sizeof(uint32_t));
+    assert_rejected(copy, length);
+    memcpy(copy, data, length);
+
+    // Obszary 1 i 2 są nawzajem swoimi rodzicami.
+    memcpy(copy + areas + sizeof(uint32_t), cycle, sizeof(cycle));
+    assert_rejected(copy, length);
+    memcpy(copy, data, length);
+
+    // Pole brzegu gracza leży poza planszą.
+    memcpy(copy + frontier, outside, sizeof(outside));
+    assert_rejected(copy, length);
+    memcpy(copy, data, length);
+
+    // Rozmiar drzewa obszaru 1 nie zgadza się z lasem.
+    memcpy(copy + areas + (next_area + 1) * sizeof(uint32_t), &cycle[0], sizeof(uint32_t));
+    assert_rejected(copy, length);
+
+    // Liczby pól i pól brzegu pierwszego gracza nie zgadzają się z planszą.
+    for (size_t i = 1; i <= 2; i++) {
+        memcpy(copy, data, length);
+        copy[players + i * sizeof(uint64_t)]++;
+        assert_rejected(copy, length);
+    }
+
+    free(copy);
+    free(data);
+    game_delete(g);
+
+    // Obszary jednego spójnego obszaru tworzą łańcuch głębszy, niż pozwala
+    // łączenie według rozmiaru, choć rozmiar drzewa jest poprawny.
+    g = game_new(21, 1, 1, 11);
+    assert(g != NULL);
+
+    for (uint32_t x = 0; x < 21; x += 2) {
+        assert(game_move(g, 1, x, 0));
+    }
+
+    for (uint32_t x = 1; x < 21; x += 2) {
+        assert(game_move(g, 1, x, 0));
+    }
+
+    data = saved_game(g, &length);
+    memcpy(&areas, data + 88, sizeof(uint64_t));
+
+    for (uint32_t i = 1; i <= 11; i++) {
+        uint32_t parent = i > 1 ? i - 1 : 1;
+
+        memcpy(data + areas + i * sizeof(uint32_t), &parent, sizeof(uint32_t));
+    }
+
+    uint32_t const chain_size = 11;
+    memcpy(data + areas + 13 * sizeof(uint32_t), &chain_size, sizeof(uint32_t));
+    assert_rejected(data, length);
+
+    free(data);
+    game_delete(g);
+
+    // Pole kwadratu rzadkiej planszy poza planszą nie jest puste.
+    g = game_new_sparse(10, 10, 3, 2);
+    assert(g != NULL);
+    assert(game_move(g, 1, 0, 0));
+    data = saved_game(g, &length);
+    memcpy(&owners, data + 104, sizeof(uint64_t));
+    data[owners + sizeof(uint64_t) + 10] = 1;
+    assert_rejected(data, length);
+
+    free(data);
+    game_delete(g);
+}
+
+/** @brief Testuje dziennik ruchów.
+ * Sprawdza nagłówek i rekordy dziennika zapisanego przez funkcje
+ * game_move i game_move_batch oraz zapis dziennika podczas usuwania gry.
+ */
+static void test_journal(void) {
+    game_t *g = game_new(300, 2, 2, 1);
+    FILE *file = tmpfile();
+
+    assert(g != NULL && file != NULL);
+    assert(!game_journal_stop(g));
+    assert(game_journal_start(g, fileno(file)));
+    assert(!game_journal_start(g, fileno(file)));
+    assert(game_move(g, 1, 0, 0));
+    assert(!game_move(g, 2, 0, 0));
+    assert(game_move(g, 2, 299, 1));
+
+    game_move_t moves[] = {{1, 1, 0}, {2, 1000, 0}};
+    assert(game_move_batch(g, moves, 2, NULL) == 1);
+    assert(game_journal_stop(g));
+    assert(game_move(g, 1, 2, 0));
+
+    // Nagłówek i pięć rekordów: bajt wyniku i długości liczb oraz liczby.
+    static const uint8_t records[] = {
+        1, 1, 0, 0,
+        0, 2, 0, 0,
+        9, 2, 43, 1, 1,
+        1, 1, 1, 0,
+        8, 2, 232, 3, 0
+    };
+    uint8_t journal[32 + sizeof(records) + 1];
+    uint32_t header[6];
+
+    rewind(file);
+    assert(fread(journal, 1, sizeof(journal), file) == sizeof(journal) - 1);
+    assert(memcmp(journal, "IPPMOVE", 8) == 0);
+    memcpy(header, journal + 8, sizeof(header));
+    assert(header[0] == 1 && header[1] == 0x01020304u);
+    assert(header[2] == 300 && header[3] == 2 && header[4] == 2 && header[5] == 1);
+    assert(memcmp(journal + 32, records, sizeof(records)) == 0);
+
+    // Dziennik jest zapisywany także podczas usuwania gry.
+    assert(game_journal_start(g, fileno(file)));
+    assert(game_move(g, 1, 3, 0));
+    game_delete(g);
+    assert(fseek(file, 0, SEEK_END) == 0);
+    assert(ftell(file) == 32 + sizeof(records) + 32 + 4);
+
+    fclose(file);
+}
+
+/** @brief Testuje funkcję game_clone.
+ * Wykonuje różne pseudolosowe ruchy na grze i jej kopiach i porównuje je
+ * z grami, w których wykonano te same ruchy bez kopiowania.
+ */
+static void test_clone(bool sparse) {
+    game_t *g = sparse ? game_new_sparse(100, 80, 5, 4) : game_new(100, 80, 5, 4);
+    assert(g != NULL);
+    assert(game_clone(NULL) == NULL);
+    play_random_moves(g, 1, 3000);
+
+    game_t *c = game_clone(g);
+    assert(c != NULL);
+    game_t *d = game_clone(c);
+    assert(d != NULL);
+    assert_same_game(g, d);
+
+    // Każda z gier ma swoje ruchy, a plansza oryginału jest usuwana pierwsza.
+    play_random_moves(g, 2, 2000);
+    play_random_moves(d, 3, 2000);
+
+    game_t *expected = game_new(100, 80, 5, 4);
+    assert(expected != NULL);
+    play_random_moves(expected, 1, 3000);
+    play_random_moves(expected, 2, 2000);
+    assert_same_game(g, expected);
+    game_delete(g);
+    game_delete(expected);
+
+    play_random_moves(c, 4, 2000);
+    expected = game_new(100, 80, 5, 4);
+    assert(expected != NULL);
+    play_random_moves(expected, 1, 3000);
+    play_random_moves(expected, 4, 2000);
+    assert_same_game(c, expected);
+    game_delete(c);
+    game_delete(expected);
+
+    expected = game_new(100, 80, 5, 4);
+    assert(expected != NULL);
+    play_random_moves(expected, 1, 3000);
+    play_random_moves(expected, 3, 2000);
+    assert_same_game(d, expected);
+
+    // Ostatnia gra korzystająca ze wspólnej planszy wraca do zwykłej planszy.
+    play_random_moves(d, 6, 2000);
+    play_random_moves(expected, 6, 2000);
+    assert_same_game(d, expected);
+
+    // Gra o wspólnej planszy jest zapisywana jak każda inna.
+    FILE *file = tmpfile();
+    assert(file != NULL);
+    assert(game_save(d, fileno(file)));
+    game_t *loaded = game_load(fileno(file));
+    assert(loaded != NULL);
+    fclose(file);
+    assert_same_game(loaded, expected);
+
+    // Kopia wczytanej gry nie zależy od pliku wczytanej gry.
+    game_t *e = game_clone(loaded);
+    assert(e != NULL);
+    game_delete(loaded);
+    play_random_moves(e, 5, 2000);
+    play_random_moves(expected, 5, 2000);
+    assert_same_game(e, expected);
+
+    game_delete(e);
+    game_delete(d);
+    game_delete(expected);
+
+    // Krótki brzeg kopii rośnie o cztery pola naraz.
+    g = sparse ? game_new_sparse(10, 10, 1, 2) : game_new(10, 10, 1, 2);
+    assert(g != NULL && game_move(g, 1, 0, 0));
+    c = game_clone(g);
+    assert(c != NULL && game_move(c, 1, 5, 5));
+    assert(game_free_fields(c, 1) == 6);
+    game_delete(c);
+    game_delete(g);
+}
+
+/** @brief Sprawdza, czy gracze mają w obu grach te same legalne ruchy.
+ * Porównuje zbiory pól podanych przez funkcję game_legal_moves dla każdego
+ * gracza gier @p g i @p h.
+ */
+static void assert_same_moves(game_t *g, game_t *h) {
+    static game_field_t p[4000], q[4000];
+
+    for (uint32_t player = 1; player <= game_players(g); player++) {
+        uint64_t length = game_legal_moves(g, player, p, 4000);
+
+        assert(length == game_legal_moves(h, player, q, 4000));
+        assert(length <= 4000);
+
+        // Kolejność pól brzegu może być inna, porównujemy więc zbiory pól.
+        for (uint64_t i = 0; i < length; i++) {
+            uint64_t j = 0;
+
+            while (j < length && (p[i].x != q[j].x || p[i].y != q[j].y)) {
+                j++;
+            }
+
+            assert(j < length);
+        }
+    }
+}
+
+/** @brief Testuje funkcje game_undo i game_redo.
+ * Cofa połowę pseudolosowych ruchów, wykonuje je ponownie i porównuje grę
+ * z grą, w której wykonano tylko niecofnięte ruchy.
+ */
+static void test_undo(bool sparse) {
+    game_t *g = sparse ? game_new_sparse(50, 40, 5, 4) : game_new(50, 40, 5, 4);
+    game_t *h = sparse ? game_new_sparse(50, 40, 5, 4) : game_new(50, 40, 5, 4);
+    static game_move_t made[3000];
+    uint32_t count = 0;
+    uint64_t seed = 11;
+
+    assert(g != NULL && h != NULL);
+    assert(!game_undo(g));
+    assert(game_history_enable(g));
+    assert(!game_undo(g) && !game_redo(g));
+
+    if (!sparse) {
+        assert(game_bitboards_enable(g));
+    }
+
+    for (uint32_t i = 0; i < 3000; i++) {
+        game_move_t move = game_random_move(&seed, 5, 50, 40);
+
+        if (game_move(g, move.player, move.x, move.y)) {
+            made[count] = move;
+            count++;
+        }
+    }
+
+    // Cofamy połowę ruchów i porównujemy z grą, w której ich nie było.
+    for (uint32_t i = 0; i < count / 2; i++) {
+        assert(game_move(h, made[i].player, made[i].x, made[i].y));
+    }
+    for (uint32_t i = count / 2; i < count; i++) {
+        assert(game_undo(g));
+    }
+
+    assert_same_game(g, h);
+    assert_same_moves(g, h);
+
+    // Ponownie wykonane ruchy dają grę, w której nic nie cofano.
+    for (uint32_t i = count / 2; i < count; i++) {
+        assert(game_move(h, made[i].player, made[i].x, made[i].y));
+        assert(game_redo(g));
+    }
+
+    assert(!game_redo(g));
+    assert_same_game(g, h);
+    assert_same_moves(g, h);
+
+    // Nowy ruch uniemożliwia ponowne wykonanie cofniętych ruchów.
+    while (game_undo(g)) {
+    }
+
+    assert(game_busy_fields(g, made[0].player) == 0);
+    assert(game_move(g, made[1].player, made[1].x, made[1].y));
+    assert(!game_redo(g));
+    assert(game_undo(g) && game_redo(g));
+
+    // Cofnięcie ruchu kopii nie zmienia gry, z której ją utworzono.
+    game_t *c = game_clone(g);
+
+    assert(c != NULL && !game_undo(c));
+    assert(game_history_enable(c));
+    assert(game_move(c, made[0].player, made[0].x, made[0].y));
+    assert(game_undo(g));
+    assert(game_busy_fields(c, made[1].player) == 1 + (made[0].player == made[1].player));
+    assert(game_undo(c));
+    assert(game_busy_fields(g, made[1].player) == 0);
+
+    game_history_disable(g);
+    assert(!game_undo(g));
+
+    game_delete(c);
+    game_delete(g);
+    game_delete(h);
+}
+
+/** @brief Testuje dziennik ruchów z historią.
+ * Sprawdza rekordy dziennika zapisywane przy włączaniu historii, cofaniu
+ * i ponownym wykonywaniu ruchów.
+ */
+static void test_undo_journal(void) {
+    game_t *g = game_new(3, 3, 2, 1);
+    FILE *file = tmpfile();
+
+    assert(g != NULL && file != NULL);
+    assert(game_history_enable(g));
+    assert(game_journal_start(g, fileno(file)));
+    assert(game_move(g, 1, 0, 0));
+    assert(game_undo(g));
+    assert(!game_undo(g));
+    assert(game_redo(g));
+    game_history_disable(g);
+    assert(game_journal_stop(g));
+
+    // Włączenie historii, ruch, dwa cofnięcia, ponowny ruch i wyłączenie historii.
+    static const uint8_t records[] = {0x87, 1, 1, 0, 0, 0x83, 0x82, 0x85, 0x89};
+    uint8_t journal[32 + sizeof(records) + 1];
+
+    rewind(file);
+    assert(fread(journal, 1, sizeof(journal), file) == sizeof(journal) - 1);
+    assert(memcmp(journal + 32, records, sizeof(records)) == 0);
+
+    game_delete(g);
+    fclose(file);
+}
+
+/** @brief Testuje funkcję game_hash i tablicę transpozycji.
+ * Sprawdza, czy skrót zależy tylko od stanu planszy, oraz zapisywanie
+ * i wyszukiwanie pozycji w tablicy transpozycji.
+ */
+static void test_hash(void) {
+    game_t *g = game_new(10, 10, 2, 5);
+    game_t *h = game_new(10, 10, 2, 5);
+
+    assert(g != NULL && h != NULL);
+    assert(game_hash(NULL) == 0 && game_hash(g) == 0);
+
+    // Skrót nie zależy od kolejności ruchów.
+    assert(game_move(g, 1, 0, 0) && game_move(g, 2, 5, 5) && game_move(g, 1, 1, 0));
+    assert(game_move(h, 1, 1, 0) && game_move(h, 1, 0, 0) && game_move(h, 2, 5, 5));
+    assert(game_hash(g) == game_hash(h) && game_hash(g) != 0);
+    assert(!game_move(h, 2, 0, 0));
+    assert(game_hash(g) == game_hash(h));
+
+    uint64_t hash = game_hash(g);
+    assert(game_history_enable(g));
+    assert(game_move(g, 2, 6, 5));
+    assert(game_hash(g) != hash);
+    assert(game_undo(g));
+    assert(game_hash(g) == hash);
+
+    // Ten sam pionek innego gracza daje inny skrót.
+    assert(game_move(h, 1, 6, 5));
+    assert(game_redo(g));
+    assert(game_hash(g) != game_hash(h));
+
+    game_t *c = game_clone(g);
+    assert(c != NULL && game_hash(c) == game_hash(g));
+
+    FILE *file = tmpfile();
+    assert(file != NULL && game_save(g, fileno(file)));
+    game_t *loaded = game_load(fileno(file));
+    assert(loaded != NULL && game_hash(loaded) == game_hash(g));
+    fclose(file);
+
+    // Tablica transpozycji ma 4 pozycje.
+    game_table_t *t = game_table_new(3);
+    uint64_t value;
+    assert(t != NULL && game_table_new(0) == NULL);
+    assert(!game_table_find(t, hash, &value));
+    game_table_store(t, hash, 42);
+    assert(game_table_find(t, hash, &value) && value == 42);
+    assert(!game_table_find(t, hash + 4, &value));
+    game_table_store(t, hash + 4, 7);
+    assert(game_table_find(t, hash + 4, &value) && value == 7);
+    assert(!game_table_find(t, hash, &value));
+    game_table_store(t, 0, 0);
+    assert(game_table_find(t, 0, &value) && value == 0);
+    game_table_delete(t);
+    game_table_delete(NULL);
+
+    game_delete(loaded);
+    game_delete(c);
+    game_delete(g);
+    game_delete(h);
+}
+
+/** @brief Testuje funkcję game_stats.
+ * Sprawdza liczniki silnika skompilowanego z -DGAME_STATS, a w pozostałych
+ * przypadkach tylko to, że funkcja zgłasza błąd ENOTSUP.
+ */
+static void test_stats(void) {
+    game_t *g = game_new(5, 5, 2, 2);
+    game_stats_t stats;
+
+    assert(g != NULL && !game_stats(NULL, &stats) && !game_stats(g, NULL));
+
+    assert(game_move(g, 1, 0, 0) && game_move(g, 1, 2, 0));
+    assert(!game_move(g, 2, 0, 0) && game_move(g, 2, 4, 4));
+    assert(!game_move(g, 1, 4, 0));
+    assert(game_move(g, 1, 1, 0));
+
+    errno = 0;
+
+    // Liczniki są zliczane tylko w silniku skompilowanym z -DGAME_STATS.
+    if (!game_stats(g, &stats)) {
+        assert(errno == ENOTSUP);
+        game_delete(g);
+
+        return;
+    }
+
+    assert(stats.moves == 6 && stats.made_moves == 4);
+    assert(stats.new_areas == 3 && stats.areas_failures == 1);
+    assert(stats.merging_moves == 1 && stats.merged_areas == 1);
+    assert(stats.compactions == 0);
+
+    game_t *c = game_clone(g);
+    assert(c != NULL && game_stats(c, &stats) && stats.moves == 0);
+
+    game_delete(c);
+    game_delete(g);
+}
+
+/** @brief Testuje gry z więcej niż 61 graczami.
+ * Gracze są wtedy oznaczani na planszy numerami, a gracze 1 i 256 mają
+ * na planszy ten sam znacznik, więc ich obszary są rozróżniane tylko
+ * przez numery graczy.
+ */
+static void test_many_players(void) {
+    game_t *g = game_new(4, 2, 300, 1);
+    assert(g != NULL && game_players(g) == 300 && game_player(g, 1) == '.');
+
+    assert(game_move(g, 256, 0, 0) && game_move(g, 1, 1, 0));
+    assert(game_move(g, 300, 3, 1) && !game_move(g, 301, 2, 0));
+    assert(!game_move(g, 256, 2, 0) && game_move(g, 1, 2, 0));
+    assert(game_busy_fields(g, 1) == 2 && game_busy_fields(g, 256) == 1);
+    assert(game_free_fields(g, 1) == 3 && game_free_fields(g, 256) == 1);
+    assert(game_free_fields(g, 255) == 4 && game_free_fields(g, 299) == 4);
+
+    char *p = game_board(g);
+    assert(p && strcmp(p, "  .   .   . 300\n256   1   1   .\n") == 0);
+    free(p);
+
+    FILE *file = tmpfile();
+    assert(file != NULL && game_save(g, fileno(file)));
+
+    game_t *loaded = game_load(fileno(file));
+    game_t *c = game_clone(g);
+    assert(loaded != NULL && c != NULL);
+
+    // Gracz 256 nie może zająć drugiego obszaru, choć pole (3,0) sąsiaduje
+    // z polem gracza 1, który ma ten sam znacznik.
+    assert(!game_move(loaded, 256, 3, 0) && !game_move(c, 256, 3, 0));
+    assert(game_move(loaded, 256, 0, 1) && game_move(c, 256, 0, 1));
+    assert(game_move(loaded, 1, 3, 0) && game_move(c, 1, 3, 0));
+    assert(game_busy_fields(loaded, 300) == 1 && game_busy_fields(c, 256) == 2);
+    assert_same_game(loaded, c);
+    assert(game_free_fields(g, 256) == 1);
+
+    fclose(file);
+    game_delete(loaded);
+    game_delete(c);
+    game_delete(g);
+
+    g = game_new(2, 1, 100, 1);
+    assert(g != NULL && game_move(g, 100, 1, 0) && game_move(g, 7, 0, 0));
+    p = game_board(g);
+    assert(p && strcmp(p, "  7 100\n") == 0);
+    free(p);
+    game_delete(g);
+}
+
+/** @brief Testuje funkcje game_next_player i game_any_player_can_move.
+ * Gracze zajmują po kolei pola planszy o jednym wierszu, więc wszyscy
+ * poza dwoma ostatnimi są zablokowani, a ich strony tablicy graczy są pełne.
+ */
+static void test_next_player(void) {
+    uint32_t const players = 66 * 1024 + 10;
+    game_t *g = game_new(players, 1, players, 1);
+
+    assert(g != NULL && game_history_enable(g));
+    assert(game_next_player(NULL, 1) == 0 && !game_any_player_can_move(NULL));
+    assert(game_next_player(g, 0) == 1 && game_next_player(g, players) == 1);
+    assert(game_next_player(g, players + 1) == 1 && game_next_player(g, 7) == 8);
+
+    for (uint32_t x = 0; x + 1 < players; x++) {
+        assert(game_move(g, x + 1, x, 0));
+    }
+
+    assert(game_any_player_can_move(g));
+    assert(game_next_player(g, 1) == players - 1);
+    assert(game_next_player(g, players - 1) == players);
+    assert(game_next_player(g, players) == players - 1);
+
+    game_t *c = game_clone(g);
+    assert(c != NULL && game_next_player(c, 5000) == players - 1);
+
+    // Cofnięcie ruchu odblokowuje gracza, który ma znów wolne pole obok.
+    assert(game_undo(g));
+    assert(game_next_player(g, 1) == players - 2);
+    assert(game_next_player(g, players - 2) == players - 1);
+
+    assert(game_move(c, players, players - 1, 0));
+    assert(!game_any_player_can_move(c) && game_next_player(c, 1) == 0);
+
+    game_delete(c);
+    game_delete(g);
+}
+
 /** @brief Testuje silnik gry.
  * Przeprowadza przykładowe testy silnika gry.
  * @return Zero, gdy wszystkie testy przebiegły poprawnie,
@@ -223,6 +1196,26 @@ int main() {
 
     game_delete(g);
 
+    test_move_batch();
+    test_legal_moves();
+    test_frontier();
+    test_board_into();
+    test_board_write(5, 3);
+    test_board_write(2000, 1500);
+    test_sparse_board();
+    test_save_load(false);
+    test_save_load(true);
+    test_load_corrupted();
+    test_journal();
+    test_clone(false);
+    test_clone(true);
+    test_undo(false);
+    test_undo(true);
+    test_undo_journal();
+    test_hash();
+    test_stats();
+    test_many_players();
+    test_next_player();
 
     return 0;
 }
@@ -0,0 +1,98 @@
+/** @file
+ * Benchmark of the game creation.
+ *
+ * Creates games with boards of several sizes and reports how long
+ * game_new, MOVES random moves and game_delete take and how much memory
+ * the process really uses (its resident set size) after game_new and
+ * after the moves.
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+/**
+ * Funkcje clock_gettime i sysconf są częścią standardu POSIX.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "game.h"
+#include "game_random.h"
+#include <time.h>
+#include <unistd.h>
+
+// Number of the measured board sizes.
+#define SIZES 5
+
+// Number of the random moves made after the game creation.
+#define MOVES 100000
+
+// Returns the current time in seconds.
+static double now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+// Returns the resident set size of the process in kilobytes or zero
+// if it is unknown.
+static uint64_t resident_kilobytes(void) {
+    FILE* statm = fopen("/proc/self/statm", "r");
+    unsigned long size, resident = 0;
+
+    if (statm) {
+        if (fscanf(statm, "%lu %lu", &size, &resident) != 2) {
+            resident = 0;
+        }
+
+        fclose(statm);
+    }
+
+    return (uint64_t)resident * (uint64_t)sysconf(_SC_PAGESIZE) / 1024;
+}
+
+int main() {
+    uint32_t const sides[SIZES] = {100, 1000, 10000, 40000, 100000};
+
+    printf("%-14s %12s %12s %12s %12s %12s\n", "board", "new us", "RSS KB",
+           "moves us", "moves RSS KB", "delete us");
+
+    for (int i = 0; i < SIZES; i++) {
+        uint64_t seed = 7;
+        uint64_t before = resident_kilobytes();
+        double start = now();
+        game_t* g = game_new(sides[i], sides[i], 8, UINT32_MAX);
+        double created = now();
+
+        if (!g) {
+            fprintf(stderr, "Not enough memory.\n");
+
+            return 1;
+        }
+
+        uint64_t after_new = resident_kilobytes();
+
+        for (int j = 0; j < MOVES; j++) {
+            game_move_t move = game_random_move(&seed, 8, sides[i], sides[i]);
+
+            game_move(g, move.player, move.x, move.y);
+        }
+
+        double moved = now();
+        uint64_t after_moves = resident_kilobytes();
+        double deleting = now();
+
+        game_delete(g);
+
+        double end = now();
+
+        printf("%6ux%-7u %12.1f %12lu %12.1f %12lu %12.1f\n", sides[i], sides[i],
+               (created - start) * 1e6, after_new - before, (moved - created) * 1e6,
+               after_moves - before, (end - deleting) * 1e6);
+    }
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+/** @file
+ * Implementation of the interface game_random.h
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+#include "game_random.h"
+
+uint32_t game_random_number(uint64_t* seed, uint32_t bound) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+    // The lower bits of the generator have short periods.
+    return (uint32_t)(*seed >> 32) % bound;
+}
+
+game_move_t game_random_move(uint64_t* seed, uint32_t players, uint32_t width,
+                             uint32_t height) {
+    game_move_t move;
+
+    move.player = game_random_number(seed, players) + 1;
+    move.x = game_random_number(seed, width);
+    move.y = game_random_number(seed, height);
+
+    return move;
+}
@@ -0,0 +1,412 @@
+/** @file
+ * Replay of the journals of moves.
+ *
+ * game_replay <journal> [<snapshot>]
+ *     Reads the journal written by game_journal_start, makes its moves on
+ *     a new game (or on the game loaded from the snapshot written by
+ *     game_save), repeats the calls of game_undo, game_redo,
+ *     game_history_enable and game_history_disable kept in the journal
+ *     and reports how many moves per second were replayed,
+ *     how many moves gave another result than in the journal and
+ *     the checksum of the final state of the game.
+ *
+ * game_replay -r <journal> <width> <height> <players> <areas> <moves>
+ *     Plays a game of random moves and writes its journal.
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+/**
+ * Funkcje clock_gettime, open i read są częścią standardu POSIX.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "game.h"
+#include "game_random.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Length in bytes of the blocks read from the journal.
+#define BLOCK_LENGTH (1 << 20)
+
+// Number of moves given at once to game_move_batch.
+#define BATCH_LENGTH 65536
+
+/** @brief The header of the journal (see game_journal_start).
+ */
+typedef struct Journal_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t width;
+    uint32_t height;
+    uint32_t players;
+    uint32_t areas;
+} journal_header_t;
+
+/** @brief The state of the replay:
+ * g          - the replayed game,
+ * moves      - the decoded moves waiting for game_move_batch,
+ * expected   - expected[i] is the result of moves[i] kept in the journal,
+ * results    - the results of the moves given by game_move_batch,
+ * length     - the number of the decoded moves,
+ * replayed   - the number of all replayed records,
+ * different  - the number of records with the result other than in the journal,
+ * engine     - the time in seconds spent in the functions of the game.
+ */
+typedef struct Replay {
+    game_t* g;
+    game_move_t moves[BATCH_LENGTH];
+    bool expected[BATCH_LENGTH];
+    bool results[BATCH_LENGTH];
+    uint64_t length;
+    uint64_t replayed;
+    uint64_t different;
+    double engine;
+} replay_t;
+
+// Returns the current time in seconds.
+static double now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+// Reads at most length bytes, stopping only at the end of the file.
+// Returns the number of read bytes or -1 if reading failed.
+static ssize_t read_block(int fd, uint8_t* buffer, size_t length) {
+    size_t done = 0;
+
+    while (done < length) {
+        ssize_t bytes = read(fd, buffer + done, length - done);
+
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes < 0) {
+            return -1;
+        }
+        if (bytes == 0) {
+            break;
+        }
+
+        done += (size_t)bytes;
+    }
+
+    return (ssize_t)done;
+}
+
+// Decodes the number written on the length lowest bytes from in.
+static uint32_t decode_number(uint8_t const* in, int length) {
+    uint32_t value = 0;
+
+    for (int i = length - 1; i >= 0; i--) {
+        value = value << 8 | in[i];
+    }
+
+    return value;
+}
+
+// Repeats the call of the function (game_undo and so on) described by the tag
+// of the record kept in the journal. Returns false if the tag is not correct.
+static bool replay_event(replay_t* r, uint8_t tag) {
+    double start = now();
+    bool result;
+
+    switch (tag >> 1 & 0x3f) {
+        case 1:
+            result = game_undo(r->g);
+            break;
+        case 2:
+            result = game_redo(r->g);
+            break;
+        case 3:
+            result = game_history_enable(r->g);
+            break;
+        case 4:
+            game_history_disable(r->g);
+            result = true;
+            break;
+        default:
+            return false;
+    }
+
+    r->engine += now() - start;
+    r->different += result != (tag & 1);
+    r->replayed++;
+
+    return true;
+}
+
+// Makes the decoded moves and compares their results with the journal.
+static void replay_moves(replay_t* r) {
+    double start = now();
+
+    game_move_batch(r->g, r->moves, r->length, r->results);
+    r->engine += now() - start;
+
+    for (uint64_t i = 0; i < r->length; i++) {
+        r->different += r->results[i] != r->expected[i];
+    }
+
+    r->replayed += r->length;
+    r->length = 0;
+}
+
+// Decodes the records from the data and replays them. Returns the number
+// of the used bytes; the rest of the data is an incomplete record, unless
+// last is true. Returns -1 if the journal is corrupted.
+static int64_t replay_block(replay_t* r, uint8_t const* data, uint64_t length, bool last) {
+    uint8_t const* in = data;
+    uint8_t const* end = data + length;
+
+    while (in < end) {
+        int player_bytes = (*in >> 1 & 3) + 1;
+        int x_bytes = (*in >> 3 & 3) + 1;
+        int y_bytes = (*in >> 5 & 3) + 1;
+
+        // The other records are replayed after the moves decoded before them.
+        if (*in >> 7 != 0) {
+            replay_moves(r);
+
+            if (!replay_event(r, *in)) {
+                return -1;
+            }
+
+            in++;
+            continue;
+        }
+        if (end - in < 1 + player_bytes + x_bytes + y_bytes) {
+            return last ? -1 : in - data;
+        }
+
+        game_move_t* move = &r->moves[r->length];
+
+        r->expected[r->length] = *in & 1;
+        in++;
+        move->player = decode_number(in, player_bytes);
+        in += player_bytes;
+        move->x = decode_number(in, x_bytes);
+        in += x_bytes;
+        move->y = decode_number(in, y_bytes);
+        in += y_bytes;
+        r->length++;
+
+        if (r->length == BATCH_LENGTH) {
+            replay_moves(r);
+        }
+    }
+
+    return in - data;
+}
+
+// Adds the value to the FNV-1a hash.
+static uint64_t add_to_hash(uint64_t hash, uint64_t value) {
+    return (hash ^ value) * 1099511628211ULL;
+}
+
+// Returns the checksum of the state of the game: the numbers of busy and
+// free fields of every player and the board. Sets *board_hashed to false
+// if the board does not fit in the memory.
+static uint64_t game_checksum(game_t const* g, bool* board_hashed) {
+    uint64_t hash = 1469598103934665603ULL;
+
+    for (uint32_t player = 1; player <= game_players(g); player++) {
+        hash = add_to_hash(hash, game_busy_fields(g, player));
+        hash = add_to_hash(hash, game_free_fields(g, player));
+    }
+
+    char* board = game_board(g);
+
+    *board_hashed = board != NULL;
+
+    for (char* c = board; c && *c != '\0'; c++) {
+        hash = add_to_hash(hash, (unsigned char)*c);
+    }
+
+    free(board);
+
+    return hash;
+}
+
+// Creates the game described by the header of the journal or loads it
+// from the snapshot. Returns NULL if it failed.
+static game_t* start_game(journal_header_t const* h, char const* snapshot) {
+    if (!snapshot) {
+        return game_new(h->width, h->height, h->players, h->areas);
+    }
+
+    int fd = open(snapshot, O_RDONLY);
+
+    if (fd < 0) {
+        return NULL;
+    }
+
+    game_t* g = game_load(fd);
+
+    close(fd);
+
+    if (g && (game_board_width(g) != h->width || game_board_height(g) != h->height ||
+              game_players(g) != h->players)) {
+        game_delete(g);
+        g = NULL;
+    }
+
+    return g;
+}
+
+// Replays the journal kept in the file. Returns the exit code.
+static int replay(char const* journal, char const* snapshot) {
+    int fd = open(journal, O_RDONLY);
+    journal_header_t h;
+    replay_t* r = calloc(1, sizeof(replay_t));
+    uint8_t* buffer = malloc(BLOCK_LENGTH);
+
+    if (fd < 0 || !r || !buffer) {
+        fprintf(stderr, "Cannot open %s.\n", journal);
+
+        return 1;
+    }
+    if (read_block(fd, (uint8_t*)&h, sizeof(h)) != sizeof(h) ||
+        memcmp(h.magic, "IPPMOVE", 8) != 0 || h.version != 1 ||
+        h.byte_order != 0x01020304u) {
+        fprintf(stderr, "%s is not a journal of moves.\n", journal);
+
+        return 1;
+    }
+
+    r->g = start_game(&h, snapshot);
+
+    if (!r->g) {
+        fprintf(stderr, "Cannot create the game.\n");
+
+        return 1;
+    }
+
+    double start = now();
+    uint64_t kept = 0;
+    ssize_t bytes;
+
+    // Every block is decoded together with the incomplete record left
+    // at the end of the previous one.
+    do {
+        bytes = read_block(fd, buffer + kept, BLOCK_LENGTH - kept);
+
+        if (bytes < 0) {
+            fprintf(stderr, "Cannot read %s.\n", journal);
+
+            return 1;
+        }
+
+        uint64_t length = kept + (uint64_t)bytes;
+        int64_t used = replay_block(r, buffer, length, bytes == 0);
+
+        if (used < 0) {
+            fprintf(stderr, "The journal is corrupted.\n");
+
+            return 1;
+        }
+
+        kept = length - (uint64_t)used;
+        memmove(buffer, buffer + used, kept);
+    } while (bytes > 0);
+
+    replay_moves(r);
+
+    double total = now() - start;
+    bool board_hashed;
+    uint64_t checksum = game_checksum(r->g, &board_hashed);
+
+    printf("moves:          %lu\n", r->replayed);
+    printf("different:      %lu\n", r->different);
+    printf("moves/s:        %.0f\n", (double)r->replayed / total);
+    printf("engine moves/s: %.0f\n", (double)r->replayed / r->engine);
+    printf("checksum:       %016lx%s\n", checksum,
+           board_hashed ? "" : " (without the board)");
+
+    int code = r->different == 0 ? 0 : 2;
+
+    game_delete(r->g);
+    free(r);
+    free(buffer);
+    close(fd);
+
+    return code;
+}
+
+// Converts the argument to the number. Exits if it is not a correct number.
+static uint64_t number_argument(char const* argument, uint64_t max) {
+    char* end;
+    unsigned long long value = strtoull(argument, &end, 10);
+
+    if (*argument == '\0' || *end != '\0' || value > max) {
+        fprintf(stderr, "Invalid number: %s\n", argument);
+        exit(1);
+    }
+
+    return value;
+}
+
+// Plays the game of random moves and writes its journal. Returns the exit code.
+static int record(char const* argv[]) {
+    uint32_t width = (uint32_t)number_argument(argv[1], UINT32_MAX);
+    uint32_t height = (uint32_t)number_argument(argv[2], UINT32_MAX);
+    uint32_t players = (uint32_t)number_argument(argv[3], UINT32_MAX);
+    uint32_t areas = (uint32_t)number_argument(argv[4], UINT32_MAX);
+    uint64_t moves = number_argument(argv[5], UINT64_MAX);
+    int fd = open(argv[0], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    game_t* g = game_new(width, height, players, areas);
+
+    if (fd < 0 || !g || !game_journal_start(g, fd)) {
+        fprintf(stderr, "Cannot start the game.\n");
+
+        return 1;
+    }
+
+    uint64_t seed = 7;
+    double start = now();
+
+    for (uint64_t i = 0; i < moves; i++) {
+        game_move_t move = game_random_move(&seed, players, width, height);
+
+        game_move(g, move.player, move.x, move.y);
+    }
+
+    bool written = game_journal_stop(g);
+    double total = now() - start;
+
+    if (!written) {
+        fprintf(stderr, "Cannot write the journal.\n");
+    }
+
+    printf("moves/s:        %.0f\n", (double)moves / total);
+
+    game_delete(g);
+    close(fd);
+
+    return written ? 0 : 1;
+}
+
+int main(int argc, char const* argv[]) {
+    if (argc == 8 && strcmp(argv[1], "-r") == 0) {
+        return record(&argv[2]);
+    }
+    if (argc == 2 || argc == 3) {
+        return replay(argv[1], argc == 3 ? argv[2] : NULL);
+    }
+
+    fprintf(stderr, "Usage: %s <journal> [<snapshot>]\n"
+                    "       %s -r <journal> <width> <height> <players> <areas> <moves>\n",
+            argv[0], argv[0]);
+
+    return 1;
+}
@@ -0,0 +1,202 @@
+/** @file
+ * Multithreaded stress test of the game engine.
+ *
+ * Plays many seeded random games, first one after another in a single
+ * thread and then in parallel threads, where every thread keeps several
+ * games alive at once and moves them in turns. The engine keeps all its
+ * state in the game structure, so both runs have to give the same result
+ * for every game.
+ *
+ * @author Bogdan Petraszczuk <bp372955@students.mimuw.edu.pl>
+ *                            <bogdan.petraszczuk@gmail.com>
+ * @copyright Uniwersytet Warszawski
+ * @date 2023
+ */
+
+/**
+ * W tym pliku nawet w wersji release chcemy korzystać z asercji.
+ */
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "game.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Number of played games.
+#define GAMES 2048
+
+// Number of threads playing the games in parallel.
+#define THREADS 8
+
+// Number of games kept alive at once by one thread.
+#define GAMES_PER_THREAD 4
+
+// Number of moves made in one turn of a game.
+#define MOVES_PER_TURN 16
+
+/** @brief State of one random game.
+ * g       - the game structure or NULL if the game is not started,
+ * seed    - the state of the random number generator of the game,
+ * moves   - the number of moves left to make,
+ * hash    - the hash of all results seen so far.
+ */
+typedef struct Random_game {
+    game_t* g;
+    uint64_t seed;
+    uint64_t moves;
+    uint64_t hash;
+} random_game_t;
+
+// Expected hash of every game computed by the single-threaded run.
+static uint64_t expected[GAMES];
+
+// Hash of every game computed by the multithreaded run.
+static uint64_t computed[GAMES];
+
+// Number of the next game taken by some thread.
+static atomic_uint next_game;
+
+// Xorshift random number generator.
+static uint64_t next_random(uint64_t* seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+
+    return *seed;
+}
+
+// Adds the value to the FNV-1a hash.
+static uint64_t add_to_hash(uint64_t hash, uint64_t value) {
+    return (hash ^ value) * 1099511628211ULL;
+}
+
+// Creates the game number i. Its parameters depend only on i.
+static void start_game(random_game_t* game, uint32_t i) {
+    game->seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+    game->hash = 1469598103934665603ULL;
+
+    uint32_t width = next_random(&game->seed) % 64 + 1;
+    uint32_t height = next_random(&game->seed) % 64 + 1;
+    uint32_t players = next_random(&game->seed) % (i % 2 == 0 ? 4 : 61) + 1;
+    uint32_t areas = next_random(&game->seed) % 10 + 1;
+
+    game->g = game_new(width, height, players, areas);
+    game->moves = 3 * (uint64_t)width * height;
+    assert(game->g != NULL);
+}
+
+// Makes at most count random moves in the game and hashes their results.
+// Returns true if the game is over.
+static bool play_game(random_game_t* game, uint64_t count) {
+    game_t* g = game->g;
+    uint32_t players = game_players(g);
+
+    while (count > 0 && game->moves > 0) {
+        uint32_t player = next_random(&game->seed) % players + 1;
+        uint32_t x = next_random(&game->seed) % game_board_width(g);
+        uint32_t y = next_random(&game->seed) % game_board_height(g);
+
+        game->hash = add_to_hash(game->hash, game_move(g, player, x, y));
+        game->hash = add_to_hash(game->hash, game_busy_fields(g, player));
+        game->hash = add_to_hash(game->hash, game_free_fields(g, player));
+        count--;
+        game->moves--;
+    }
+
+    return game->moves == 0;
+}
+
+// Hashes the final board of the game and deletes the game.
+static uint64_t finish_game(random_game_t* game) {
+    char* board = game_board(game->g);
+
+    assert(board != NULL);
+
+    for (char* c = board; *c != '\0'; c++) {
+        game->hash = add_to_hash(game->hash, (unsigned char)*c);
+    }
+
+    free(board);
+    game_delete(game->g);
+    game->g = NULL;
+
+    return game->hash;
+}
+
+// Takes the next game not played by any thread yet. Returns false if
+// all games are already taken.
+static bool take_game(random_game_t* game, uint32_t* number) {
+    *number = atomic_fetch_add(&next_game, 1);
+
+    if (*number >= GAMES) {
+        return false;
+    }
+
+    start_game(game, *number);
+
+    return true;
+}
+
+// Plays games in one thread keeping GAMES_PER_THREAD of them alive at once.
+static void* play_in_thread(void* unused) {
+    (void)unused;
+
+    random_game_t games[GAMES_PER_THREAD];
+    uint32_t numbers[GAMES_PER_THREAD];
+    bool alive[GAMES_PER_THREAD];
+    uint32_t alive_games = 0;
+
+    for (int i = 0; i < GAMES_PER_THREAD; i++) {
+        alive[i] = take_game(&games[i], &numbers[i]);
+        alive_games += alive[i];
+    }
+
+    while (alive_games > 0) {
+        for (int i = 0; i < GAMES_PER_THREAD; i++) {
+            if (alive[i] && play_game(&games[i], MOVES_PER_TURN)) {
+                computed[numbers[i]] = finish_game(&games[i]);
+                alive[i] = take_game(&games[i], &numbers[i]);
+                alive_games -= !alive[i];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+int main() {
+    random_game_t game;
+
+    for (uint32_t i = 0; i < GAMES; i++) {
+        start_game(&game, i);
+        play_game(&game, UINT64_MAX);
+        expected[i] = finish_game(&game);
+    }
+
+    pthread_t threads[THREADS];
+
+    for (int i = 0; i < THREADS; i++) {
+        assert(pthread_create(&threads[i], NULL, play_in_thread, NULL) == 0);
+    }
+
+    for (int i = 0; i < THREADS; i++) {
+        assert(pthread_join(threads[i], NULL) == 0);
+    }
+
+    for (uint32_t i = 0; i < GAMES; i++) {
+        if (computed[i] != expected[i]) {
+            fprintf(stderr, "Game %u differs from the single-threaded run.\n", i);
+
+            return 1;
+        }
+    }
+
+    printf("wszystko ok\n");
+
+    return 0;
+}